@@ -13,15 +13,24 @@ namespace LogForge
 			LogFilter(minSeverity)
 		{}
 
-		[[nodiscard]] constexpr bool Filter(const LogEvent& event) const override
+		[[nodiscard]] constexpr bool Filter([[maybe_unused]] const LogEvent& event) const override
 		{
 		#ifdef NDEBUG
-			return false
+			return false;
 		#else
 			return event.Severity >= MinSeverity;
 		#endif
 		}
 
+		[[nodiscard]] constexpr bool IsEnabled([[maybe_unused]] const Severity severity) const override
+		{
+		#ifdef NDEBUG
+			return false;
+		#else
+			return severity >= MinSeverity;
+		#endif
+		}
+
 	};
 
 }
\ No newline at end of file
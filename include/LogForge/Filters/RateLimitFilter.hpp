@@ -0,0 +1,191 @@
+#pragma once
+
+#include "../LogFilter.hpp"
+#include "../Logger.hpp"
+#include "../Utilities/CallSiteMap.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <concepts>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+
+namespace LogForge
+{
+
+	/// Structure that describes how many events a single call site may log
+	struct RateLimit
+	{
+		std::uint32_t Events = 100;							///< Events that are allowed per period on average
+		std::chrono::nanoseconds Period = std::chrono::seconds(1);	///< Period that the events refer to
+		std::uint32_t Burst = 100;							///< Events that may be logged in a row before the average applies
+		std::optional<Severity> ExemptSeverity = Severity::Fatal;	///< Events of this severity or above are never limited
+
+		[[nodiscard]] static constexpr RateLimit PerSecond(const std::uint32_t events) noexcept
+		{
+			return { .Events = events, .Burst = events };
+		}
+
+		[[nodiscard]] static constexpr RateLimit PerMinute(const std::uint32_t events) noexcept
+		{
+			return { .Events = events, .Period = std::chrono::minutes(1), .Burst = events };
+		}
+	};
+
+	/// Function that is called with the first event that passes a call site after others were suppressed
+	using SuppressionReporter = std::function<void(const LogEvent& event, std::uint64_t suppressed)>;
+
+	/// Filter that limits how often every call site may log, on top of another filter.
+	///
+	/// Every call site gets a token bucket that holds up to Burst events and refills
+	/// at Events per Period; events that find it empty are dropped and counted. The
+	/// bucket is a single atomic time stamp (the time at which it will be full
+	/// again) that is advanced with a compare-and-swap, and call sites are found in
+	/// a CallSiteMap, so the filter never locks. Only events that the wrapped filter
+	/// accepts take tokens. Once the map is full, new call sites are not limited.
+	///
+	/// When a call site passes again after events were dropped, Reporter is called
+	/// with that event and the number of dropped events before it is logged. Events
+	/// logged from within the reporter are never limited, so it can log the summary
+	/// through the logger that owns the filter, see ReportTo(). Copies of the filter
+	/// share their buckets.
+	template <std::derived_from<LogFilter> InnerFilter>
+	class RateLimitFilter final : public LogFilter
+	{
+	public:
+
+		explicit RateLimitFilter(InnerFilter realFilter, const LogForge::RateLimit rateLimit = {}, LogForge::SuppressionReporter reporter = nullptr) :
+			LogFilter(realFilter.MinSeverity),
+			RealFilter(std::move(realFilter)),
+			Reporter(std::move(reporter)),
+			m_Interval(std::max<std::int64_t>(rateLimit.Period.count() / std::max<std::uint32_t>(rateLimit.Events, 1), 1)),
+			m_Tolerance(m_Interval * (std::max<std::uint32_t>(rateLimit.Burst, 1) - 1)),
+			m_ExemptSeverity(rateLimit.ExemptSeverity),
+			m_Buckets(std::make_shared<CallSiteMap<Bucket>>())
+		{}
+
+		[[nodiscard]] bool Filter(const LogEvent& event) const override
+		{
+			if (not RealFilter.Filter(event)) return false;
+			if (IsReporting()) return true;
+			if (m_ExemptSeverity.has_value() and event.Severity >= m_ExemptSeverity.value()) return true;
+
+			const auto* bucket = m_Buckets->GetOrInsert(event.SourceLocation, [] { return Bucket(); });
+			if (bucket == nullptr) return true;
+
+			if (not TakeToken(*bucket))
+			{
+				bucket->Suppressed.fetch_add(1, std::memory_order_relaxed);
+				return false;
+			}
+
+			if (bucket->Suppressed.load(std::memory_order_relaxed) != 0)
+			{
+				Report(event, bucket->Suppressed.exchange(0, std::memory_order_relaxed));
+			}
+
+			return true;
+		}
+
+		[[nodiscard]] bool IsEnabled(const Severity severity) const override
+		{
+			return RealFilter.IsEnabled(severity);
+		}
+
+		/// Returns the number of events of the call site that were dropped and not reported yet
+		[[nodiscard]] std::uint64_t GetSuppressed(const SourceLocation& location) const noexcept
+		{
+			const auto* bucket = m_Buckets->Find(location);
+			return bucket != nullptr ? bucket->Suppressed.load(std::memory_order_relaxed) : 0;
+		}
+
+	private:
+
+		/// Token bucket of a call site as the time at which it will be full again, in steady clock nanoseconds
+		struct Bucket
+		{
+			Bucket() noexcept = default;
+
+			/// Only needed to create the map entry, which is never moved once it is shared
+			Bucket(Bucket&& other) noexcept :
+				FullAt(other.FullAt.load(std::memory_order_relaxed)),
+				Suppressed(other.Suppressed.load(std::memory_order_relaxed))
+			{}
+
+			mutable std::atomic<std::int64_t> FullAt = 0;
+			mutable std::atomic<std::uint64_t> Suppressed = 0;
+		};
+
+		/// Every event moves the time at which the bucket is full by one interval into the future.
+		/// If that time is further ahead than the burst allows, the bucket is empty.
+		[[nodiscard]] bool TakeToken(const Bucket& bucket) const noexcept
+		{
+			const auto now = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+			auto fullAt = bucket.FullAt.load(std::memory_order_relaxed);
+
+			for (;;)
+			{
+				const auto start = std::max<std::int64_t>(fullAt, now);
+				if (start - now > m_Tolerance) return false;
+
+				if (bucket.FullAt.compare_exchange_weak(fullAt, start + m_Interval, std::memory_order_relaxed, std::memory_order_relaxed))
+				{
+					return true;
+				}
+			}
+		}
+
+		void Report(const LogEvent& event, const std::uint64_t suppressed) const
+		{
+			if (suppressed == 0 or Reporter == nullptr) return;
+
+			IsReporting() = true;
+			Reporter(event, suppressed);
+			IsReporting() = false;
+		}
+
+		/// Set while the reporter runs on this thread
+		[[nodiscard]] static bool& IsReporting() noexcept
+		{
+			thread_local bool reporting = false;
+			return reporting;
+		}
+
+	public:
+
+		InnerFilter RealFilter;
+		LogForge::SuppressionReporter Reporter;
+
+	private:
+
+		std::int64_t m_Interval;
+		std::int64_t m_Tolerance;
+		std::optional<Severity> m_ExemptSeverity;
+		std::shared_ptr<CallSiteMap<Bucket>> m_Buckets;
+
+	};
+
+	[[nodiscard]] inline auto RateLimited(std::derived_from<LogFilter> auto filter, const RateLimit rateLimit = {}, SuppressionReporter reporter = nullptr)
+	{
+		return RateLimitFilter(std::move(filter), rateLimit, std::move(reporter));
+	}
+
+	/// Returns a reporter that logs "N events suppressed" through the logger, with the
+	/// severity and source location of the event that passed the call site again
+	[[nodiscard]] inline SuppressionReporter ReportTo(const Logger& logger)
+	{
+		return [&logger](const LogEvent& event, const std::uint64_t suppressed)
+		{
+			logger.Log({
+				.Severity = event.Severity,
+				.Message = DeferredMessage(LOGFORGE_TEXT("{} events suppressed"), suppressed),
+				.Time = event.Time,
+				.SourceLocation = event.SourceLocation
+			});
+		};
+	}
+
+}
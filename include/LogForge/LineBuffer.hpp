@@ -0,0 +1,298 @@
+#pragma once
+
+#include "Types.hpp"
+#include "Utilities/Encoding.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <vector>
+
+namespace LogForge
+{
+
+	class LineBuffer;
+
+	/// Free space that is kept in front of and behind every new line of a LineBuffer
+	struct LineReserve
+	{
+		std::size_t Head = 0;	///< Characters kept free in front of each line
+		std::size_t Tail = 0;	///< Characters kept free behind each line
+
+		[[nodiscard]] constexpr LineReserve operator + (const LineReserve& other) const noexcept
+		{
+			return { Head + other.Head, Tail + other.Tail };
+		}
+	};
+
+	/// Read-only view of a consecutive range of lines inside a LineBuffer
+	class LineRange final
+	{
+	public:
+
+		class Iterator final
+		{
+		public:
+
+			using value_type = LineView;
+			using difference_type = std::ptrdiff_t;
+			using iterator_category = std::forward_iterator_tag;
+
+			constexpr Iterator() noexcept = default;
+
+			constexpr Iterator(const LineBuffer* buffer, const std::size_t index) noexcept :
+				m_Buffer(buffer),
+				m_Index(index)
+			{}
+
+			[[nodiscard]] LineView operator * () const noexcept;
+
+			constexpr Iterator& operator ++ () noexcept
+			{
+				++m_Index;
+				return *this;
+			}
+
+			constexpr Iterator operator ++ (int) noexcept
+			{
+				auto copy = *this;
+				++m_Index;
+				return copy;
+			}
+
+			[[nodiscard]] constexpr bool operator == (const Iterator& other) const noexcept = default;
+
+		private:
+
+			const LineBuffer* m_Buffer = nullptr;
+			std::size_t m_Index = 0;
+
+		};
+
+		constexpr LineRange(const LineBuffer& buffer, const std::size_t first, const std::size_t last) noexcept :
+			m_Buffer(&buffer),
+			m_First(first),
+			m_Last(last)
+		{}
+
+		[[nodiscard]] constexpr Iterator begin() const noexcept { return { m_Buffer, m_First }; }
+		[[nodiscard]] constexpr Iterator end() const noexcept { return { m_Buffer, m_Last }; }
+		[[nodiscard]] constexpr std::size_t size() const noexcept { return m_Last - m_First; }
+		[[nodiscard]] constexpr bool empty() const noexcept { return m_First == m_Last; }
+		[[nodiscard]] LineView operator [] (std::size_t index) const noexcept;
+
+	private:
+
+		const LineBuffer* m_Buffer;
+		std::size_t m_First;
+		std::size_t m_Last;
+
+	};
+
+	/// Reusable storage that printers render the lines of an event into.
+	///
+	/// All characters live in one contiguous buffer and every line is an offset
+	/// range inside it. Decorating printers add text in front of or behind lines
+	/// that were written by the printers they wrap. Clear() keeps the capacity,
+	/// so once a buffer has seen a few events, rendering does not allocate.
+	///
+	/// With a LineReserve set, every new line gets free space on both sides, so
+	/// prefixes and suffixes are written in place. Only text that does not fit
+	/// into that space moves the line to the end of the buffer.
+	///
+	/// Views returned by the buffer are invalidated by every modification, and
+	/// text passed to a modifying function must not point into the buffer itself.
+	class LineBuffer final
+	{
+	public:
+
+		LineBuffer() = default;
+
+		/// Sets the free space that new lines get around them
+		void SetLineReserve(const LineReserve reserve) noexcept
+		{
+			m_Reserve = reserve;
+		}
+
+		[[nodiscard]] LineReserve GetLineReserve() const noexcept
+		{
+			return m_Reserve;
+		}
+
+		/// Removes all lines but keeps the allocated memory and the line reserve
+		void Clear() noexcept
+		{
+			m_Characters.clear();
+			m_Lines.clear();
+		}
+
+		[[nodiscard]] std::size_t LineCount() const noexcept
+		{
+			return m_Lines.size();
+		}
+
+		[[nodiscard]] bool IsEmpty() const noexcept
+		{
+			return m_Lines.empty();
+		}
+
+		[[nodiscard]] LineView operator [] (const std::size_t index) const noexcept
+		{
+			const auto& span = m_Lines[index];
+			return LineView(m_Characters.data() + span.Begin, span.End - span.Begin);
+		}
+
+		/// Returns the lines starting at the given index
+		[[nodiscard]] LineRange GetLines(const std::size_t first = 0) const noexcept
+		{
+			return LineRange(*this, first, m_Lines.size());
+		}
+
+		/// Appends a new line and returns its index
+		std::size_t AddLine(const LineView text = {})
+		{
+			return InsertLine(m_Lines.size(), text);
+		}
+
+		/// Inserts a new line in front of the line at the given index and returns the index
+		std::size_t InsertLine(const std::size_t index, const LineView text = {})
+		{
+			const auto front = Allocate(m_Reserve.Head + text.size() + m_Reserve.Tail);
+			const auto begin = front + m_Reserve.Head;
+			std::ranges::copy(text, m_Characters.begin() + begin);
+
+			const auto end = begin + text.size();
+			m_Lines.insert(m_Lines.begin() + index, Span { .Front = front, .Begin = begin, .End = end, .Limit = end + m_Reserve.Tail });
+			return index;
+		}
+
+		/// Appends text to the end of the given line
+		void Append(const std::size_t line, const LineView text)
+		{
+			const auto end = Reserve(line, text.size());
+			std::ranges::copy(text, m_Characters.begin() + end);
+			m_Lines[line].End += text.size();
+		}
+
+		/// Appends a character the given number of times to the end of the given line
+		void Append(const std::size_t line, const std::size_t count, const Line::value_type character)
+		{
+			const auto end = Reserve(line, count);
+			std::fill_n(m_Characters.begin() + end, count, character);
+			m_Lines[line].End += count;
+		}
+
+		/// Inserts text at the start of the given line
+		void Prepend(const std::size_t line, const LineView text)
+		{
+			const auto begin = ReserveFront(line, text.size());
+			std::ranges::copy(text, m_Characters.begin() + begin);
+		}
+
+		/// Inserts a character the given number of times at the start of the given line
+		void Prepend(const std::size_t line, const std::size_t count, const Line::value_type character)
+		{
+			const auto begin = ReserveFront(line, count);
+			std::fill_n(m_Characters.begin() + begin, count, character);
+		}
+
+		/// Returns the display width of the widest line starting at the given index
+		[[nodiscard]] std::size_t GetLongestLineWidth(const std::size_t first = 0) const noexcept
+		{
+			std::size_t longest = 0;
+			for (std::size_t i = first; i < m_Lines.size(); ++i)
+			{
+				longest = std::max(longest, GetDisplayWidth((*this)[i]));
+			}
+
+			return longest;
+		}
+
+		/// Copies the lines into separate strings
+		[[nodiscard]] Lines ToLines() const
+		{
+			const auto lines = GetLines();
+			return Lines(lines.begin(), lines.end());
+		}
+
+	private:
+
+		/// Location of a line inside the character buffer. The characters between
+		/// Front and Begin and between End and Limit belong to the line but are not used yet.
+		struct Span
+		{
+			std::size_t Front;
+			std::size_t Begin;
+			std::size_t End;
+			std::size_t Limit;
+		};
+
+		/// Grows the character buffer and returns the offset of the new characters
+		std::size_t Allocate(const std::size_t count)
+		{
+			const auto offset = m_Characters.size();
+			m_Characters.resize(offset + count);
+			return offset;
+		}
+
+		/// Makes room for count characters behind the line and returns the offset they go to
+		std::size_t Reserve(const std::size_t line, const std::size_t count)
+		{
+			auto& span = m_Lines[line];
+			if (span.End + count <= span.Limit) return span.End;
+
+			if (span.Limit == m_Characters.size())
+			{
+				Allocate(span.End + count - span.Limit);
+				span.Limit = span.End + count;
+				return span.End;
+			}
+
+			Relocate(line, 0, count);
+			return m_Lines[line].End;
+		}
+
+		/// Makes room for count characters in front of the line and returns the new start of the line
+		std::size_t ReserveFront(const std::size_t line, const std::size_t count)
+		{
+			if (m_Lines[line].Begin - m_Lines[line].Front < count)
+			{
+				Relocate(line, count, 0);
+			}
+
+			return m_Lines[line].Begin -= count;
+		}
+
+		/// Moves the line to the end of the buffer, leaving at least the given amount of free space around it
+		void Relocate(const std::size_t line, const std::size_t head, const std::size_t tail)
+		{
+			const auto length = m_Lines[line].End - m_Lines[line].Begin;
+			const auto headSpace = head + m_Reserve.Head;
+			const auto region = Allocate(headSpace + length + tail + m_Reserve.Tail);
+
+			auto& span = m_Lines[line];
+			std::copy_n(m_Characters.begin() + span.Begin, length, m_Characters.begin() + region + headSpace);
+
+			span.Front = region;
+			span.Begin = region + headSpace;
+			span.End = span.Begin + length;
+			span.Limit = span.End + tail + m_Reserve.Tail;
+		}
+
+		Line m_Characters;
+		std::vector<Span> m_Lines;
+		LineReserve m_Reserve;
+
+	};
+
+	inline LineView LineRange::Iterator::operator * () const noexcept
+	{
+		return (*m_Buffer)[m_Index];
+	}
+
+	inline LineView LineRange::operator [] (const std::size_t index) const noexcept
+	{
+		return (*m_Buffer)[m_First + index];
+	}
+
+}
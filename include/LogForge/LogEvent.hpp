@@ -1,6 +1,8 @@
 #pragma once
 
 #include "Types.hpp"
+#include "LogFields.hpp"
+#include "LogMessage.hpp"
 #include "Severity.hpp"
 
 namespace LogForge
@@ -9,10 +11,30 @@ namespace LogForge
 	/// Structure that represents a log event
 	struct LogEvent
 	{
-		Severity Severity;				///< Severity of the log event
+		LogForge::Severity Severity;			///< Severity of the log event
 		LogMessage Message;				///< Message of the log event
 		TimePoint Time;					///< Time of the log event
-		SourceLocation SourceLocation;	///< Source location of the log event
+		LogForge::SourceLocation SourceLocation;	///< Source location of the log event
+		LogFields Fields = {};				///< Structured key/value fields of the log event
 	};
 
+	/// Copies an event into storage that outlives the logging call, reusing the memory of the target.
+	/// Lazy messages are resolved on the calling thread, since their producers may capture locals by reference.
+	inline void AssignDetached(LogEvent& target, const LogEvent& event)
+	{
+		target.Severity = event.Severity;
+		target.Time = event.Time;
+		target.SourceLocation = event.SourceLocation;
+		target.Fields = event.Fields;
+
+		if (const auto* lazyMessage = std::get_if<LazyMessage>(&event.Message))
+		{
+			target.Message = lazyMessage->Resolve();
+		}
+		else
+		{
+			target.Message = event.Message;
+		}
+	}
+
 }
\ No newline at end of file
@@ -0,0 +1,336 @@
+#pragma once
+
+#include "Types.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <charconv>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace LogForge
+{
+
+	/// Types of the values a structured field can hold
+	enum class FieldType : std::uint8_t
+	{
+		Boolean,
+		Int,
+		UInt,
+		Float,
+		String,
+	};
+
+	/// Key and typed value of a structured field.
+	///
+	/// The key is only referenced, so it must have static storage duration (usually
+	/// a string literal). String values are only referenced as well until the field
+	/// is added to LogFields, which copies them.
+	class LogField final
+	{
+	public:
+
+		constexpr LogField(const Char* key, const bool value) noexcept :
+			Key(key), Type(FieldType::Boolean), Boolean(value)
+		{}
+
+		template <std::signed_integral T>
+		constexpr LogField(const Char* key, const T value) noexcept :
+			Key(key), Type(FieldType::Int), Int(value)
+		{}
+
+		template <std::unsigned_integral T> requires (not std::same_as<T, bool>)
+		constexpr LogField(const Char* key, const T value) noexcept :
+			Key(key), Type(FieldType::UInt), UInt(value)
+		{}
+
+		template <std::floating_point T>
+		constexpr LogField(const Char* key, const T value) noexcept :
+			Key(key), Type(FieldType::Float), Float(static_cast<double>(value))
+		{}
+
+		constexpr LogField(const Char* key, const LineView value) noexcept :
+			Key(key), Type(FieldType::String), Text(value)
+		{}
+
+		constexpr LogField(const Char* key, const Char* value) noexcept :
+			LogField(key, LineView(value))
+		{}
+
+		LogField(const Char* key, const Line& value) noexcept :
+			LogField(key, LineView(value))
+		{}
+
+		/// Appends the value as text: numbers in their shortest form, booleans as true or false, strings as they are
+		void AppendValue(Line& output) const
+		{
+			switch (Type)
+			{
+				case FieldType::Boolean:	output += Boolean ? LOGFORGE_TEXT("true") : LOGFORGE_TEXT("false"); break;
+				case FieldType::Int:		AppendNumber(output, Int); break;
+				case FieldType::UInt:		AppendNumber(output, UInt); break;
+				case FieldType::Float:		AppendNumber(output, Float); break;
+				case FieldType::String:		output += Text; break;
+			}
+		}
+
+	private:
+
+		template <typename T>
+		static void AppendNumber(Line& output, const T value)
+		{
+			std::array<char, 32> buffer;
+			const auto result = std::to_chars(buffer.data(), buffer.data() + buffer.size(), value);
+			output.append(buffer.data(), result.ptr);
+		}
+
+	public:
+
+		const Char* Key;		///< Name of the field with static storage duration
+		FieldType Type;			///< Type that selects the member holding the value
+
+		union
+		{
+			bool Boolean;
+			std::int64_t Int;
+			std::uint64_t UInt;
+			double Float;
+		};
+
+		LineView Text;			///< Value of a string field
+
+	};
+
+	/// Structured key/value fields attached to a log event.
+	///
+	/// Up to InlineFieldCount fields with InlineTextSize characters of string values
+	/// in total are stored inside the object, so events with a handful of fields never
+	/// allocate. Anything beyond that goes to the heap. String values are copied;
+	/// keys are only referenced and must have static storage duration.
+	class LogFields final
+	{
+	public:
+
+		static constexpr std::size_t InlineFieldCount = 8;
+		static constexpr std::size_t InlineTextSize = 64;
+
+		/// User-provided, so value-initialization does not zero the inline slots
+		LogFields() noexcept {}
+
+		LogFields(const std::initializer_list<LogField> fields)
+		{
+			for (const auto& field : fields)
+			{
+				Add(field);
+			}
+		}
+
+		/// Copies only the fields and text that are in use
+		LogFields(const LogFields& other) :
+			m_Count(other.m_Count),
+			m_InlineTextSize(other.m_InlineTextSize),
+			m_MoreFields(other.m_MoreFields),
+			m_Text(other.m_Text)
+		{
+			CopyInline(other);
+		}
+
+		/// Leaves the other object empty
+		LogFields(LogFields&& other) noexcept :
+			m_Count(other.m_Count),
+			m_InlineTextSize(other.m_InlineTextSize),
+			m_MoreFields(std::move(other.m_MoreFields)),
+			m_Text(std::move(other.m_Text))
+		{
+			CopyInline(other);
+			other.Clear();
+		}
+
+		/// Copies only the fields and text that are in use and keeps the memory of this object
+		LogFields& operator = (const LogFields& other)
+		{
+			if (this == &other) return *this;
+
+			m_Count = other.m_Count;
+			m_InlineTextSize = other.m_InlineTextSize;
+			m_MoreFields = other.m_MoreFields;
+			m_Text = other.m_Text;
+			CopyInline(other);
+			return *this;
+		}
+
+		/// Leaves the other object empty
+		LogFields& operator = (LogFields&& other) noexcept
+		{
+			if (this == &other) return *this;
+
+			m_Count = other.m_Count;
+			m_InlineTextSize = other.m_InlineTextSize;
+			m_MoreFields = std::move(other.m_MoreFields);
+			m_Text = std::move(other.m_Text);
+			CopyInline(other);
+			other.Clear();
+			return *this;
+		}
+
+		/// Appends a field, copying its string value
+		void Add(const LogField& field)
+		{
+			Stored stored = { .Key = field.Key, .Type = field.Type, .TextOffset = 0, .TextLength = 0, .Bits = 0 };
+
+			switch (field.Type)
+			{
+				case FieldType::Boolean:	stored.Bits = field.Boolean ? 1 : 0; break;
+				case FieldType::Int:		stored.Bits = static_cast<std::uint64_t>(field.Int); break;
+				case FieldType::UInt:		stored.Bits = field.UInt; break;
+				case FieldType::Float:		stored.Bits = std::bit_cast<std::uint64_t>(field.Float); break;
+				case FieldType::String:
+					stored.TextOffset = static_cast<std::uint32_t>(GetTextSize());
+					stored.TextLength = static_cast<std::uint32_t>(field.Text.size());
+					AppendText(field.Text);
+					break;
+			}
+
+			if (m_Count < InlineFieldCount)
+			{
+				m_Fields[m_Count] = stored;
+			}
+			else
+			{
+				m_MoreFields.push_back(stored);
+			}
+
+			++m_Count;
+		}
+
+		/// Appends a field from its key and value
+		template <typename T> requires std::constructible_from<LogField, const Char*, const T&>
+		void Add(const Char* key, const T& value)
+		{
+			Add(LogField(key, value));
+		}
+
+		/// Removes all fields but keeps allocated memory
+		void Clear() noexcept
+		{
+			m_Count = 0;
+			m_InlineTextSize = 0;
+			m_MoreFields.clear();
+			m_Text.clear();
+		}
+
+		[[nodiscard]] std::size_t Size() const noexcept
+		{
+			return m_Count;
+		}
+
+		[[nodiscard]] bool IsEmpty() const noexcept
+		{
+			return m_Count == 0;
+		}
+
+		/// Returns the field at the given index. String values point into this object.
+		[[nodiscard]] LogField operator [] (const std::size_t index) const noexcept
+		{
+			const auto& stored = index < InlineFieldCount ? m_Fields[index] : m_MoreFields[index - InlineFieldCount];
+
+			switch (stored.Type)
+			{
+				case FieldType::Boolean:	return LogField(stored.Key, stored.Bits != 0);
+				case FieldType::Int:		return LogField(stored.Key, static_cast<std::int64_t>(stored.Bits));
+				case FieldType::UInt:		return LogField(stored.Key, stored.Bits);
+				case FieldType::Float:		return LogField(stored.Key, std::bit_cast<double>(stored.Bits));
+				case FieldType::String:		break;
+			}
+
+			return LogField(stored.Key, LineView(GetTextData() + stored.TextOffset, stored.TextLength));
+		}
+
+		class Iterator final
+		{
+		public:
+
+			using value_type = LogField;
+			using difference_type = std::ptrdiff_t;
+
+			Iterator() noexcept = default;
+
+			Iterator(const LogFields* fields, const std::size_t index) noexcept :
+				m_Fields(fields),
+				m_Index(index)
+			{}
+
+			[[nodiscard]] LogField operator * () const noexcept { return (*m_Fields)[m_Index]; }
+			Iterator& operator ++ () noexcept { ++m_Index; return *this; }
+			Iterator operator ++ (int) noexcept { auto copy = *this; ++m_Index; return copy; }
+			[[nodiscard]] bool operator == (const Iterator& other) const noexcept = default;
+
+		private:
+
+			const LogFields* m_Fields = nullptr;
+			std::size_t m_Index = 0;
+
+		};
+
+		[[nodiscard]] Iterator begin() const noexcept { return { this, 0 }; }
+		[[nodiscard]] Iterator end() const noexcept { return { this, m_Count }; }
+
+	private:
+
+		/// Field with its value as raw bits and its text as a range of the text storage.
+		/// Slots and text behind the used ones are left uninitialized, so empty fields cost nothing to create.
+		struct Stored
+		{
+			const Char* Key;
+			FieldType Type;
+			std::uint32_t TextOffset;
+			std::uint32_t TextLength;
+			std::uint64_t Bits;
+		};
+
+		void CopyInline(const LogFields& other) noexcept
+		{
+			std::copy_n(other.m_Fields.begin(), std::min(m_Count, InlineFieldCount), m_Fields.begin());
+			std::copy_n(other.m_InlineText.begin(), m_InlineTextSize, m_InlineText.begin());
+		}
+
+		[[nodiscard]] std::size_t GetTextSize() const noexcept
+		{
+			return m_Text.empty() ? m_InlineTextSize : m_Text.size();
+		}
+
+		[[nodiscard]] const Char* GetTextData() const noexcept
+		{
+			return m_Text.empty() ? m_InlineText.data() : m_Text.data();
+		}
+
+		/// Appends to the inline text, or moves all text to the heap once it does not fit anymore
+		void AppendText(const LineView text)
+		{
+			if (m_Text.empty() and m_InlineTextSize + text.size() <= InlineTextSize)
+			{
+				std::ranges::copy(text, m_InlineText.begin() + m_InlineTextSize);
+				m_InlineTextSize += text.size();
+				return;
+			}
+
+			if (m_Text.empty()) m_Text.assign(m_InlineText.data(), m_InlineTextSize);
+			m_Text += text;
+		}
+
+		std::array<Stored, InlineFieldCount> m_Fields;
+		std::size_t m_Count = 0;
+		std::array<Char, InlineTextSize> m_InlineText;
+		std::size_t m_InlineTextSize = 0;
+		std::vector<Stored> m_MoreFields;
+		Line m_Text;
+
+	};
+
+}
@@ -23,6 +23,13 @@ namespace LogForge
 		virtual ~LogFilter() = default;
 		[[nodiscard]] virtual bool Filter(const LogEvent& event) const = 0;
 
+		/// Cheap check that runs before an event is built. Must not accept
+		/// severities for which Filter() would reject every event.
+		[[nodiscard]] virtual constexpr bool IsEnabled(const Severity severity) const
+		{
+			return severity >= MinSeverity;
+		}
+
 	public:
 
 		Severity MinSeverity;
@@ -3,24 +3,50 @@
 #include "LogFilter.hpp"
 #include "Filters/DevelopmentFilter.hpp"
 #include "Filters/ProductionFilter.hpp"
+#include "Filters/RateLimitFilter.hpp"
 
 #include "Logger.hpp"
+#include "Loggers/AsyncLogger.hpp"
 #include "Loggers/DefaultLogger.hpp"
 
 #include "LogOutput.hpp"
+#include "Outputs/BinaryOutput.hpp"
+#include "Outputs/FileOutput.hpp"
+#include "Outputs/FlushPolicy.hpp"
+#include "Outputs/IoUringFileOutput.hpp"
+#include "Outputs/MappedFileOutput.hpp"
 #include "Outputs/MultiOutput.hpp"
+#include "Outputs/RotatingFileOutput.hpp"
 #include "Outputs/StreamOutput.hpp"
+#include "Outputs/SynchronizedOutput.hpp"
 
 #include "LogPrinter.hpp"
 #include "Printers/BoxPrinter.hpp"
 #include "Printers/ColoredPrinter.hpp"
 #include "Printers/LocationPrinter.hpp"
+#include "Printers/JsonPrinter.hpp"
 #include "Printers/LogFmtPrinter.hpp"
 #include "Printers/MessagePrinter.hpp"
+#include "Printers/NullPrinter.hpp"
 #include "Printers/PrefixPrinter.hpp"
 #include "Printers/PrinterBuilder.hpp"
 #include "Printers/TimestampPrinter.hpp"
 
 #include "Severity.hpp"
+#include "SourceLocation.hpp"
 #include "Types.hpp"
-#include "LogEvent.hpp"
\ No newline at end of file
+#include "LogEvent.hpp"
+#include "LogFields.hpp"
+#include "LogMessage.hpp"
+#include "LineBuffer.hpp"
+
+#include "Time/LocalTime.hpp"
+#include "Time/TimeFormatter.hpp"
+
+#include "Utilities/BinaryDecoder.hpp"
+#include "Utilities/BinaryFormat.hpp"
+#include "Utilities/CallSiteMap.hpp"
+#include "Utilities/CharacterScan.hpp"
+#include "Utilities/Encoding.hpp"
+#include "Utilities/IoUring.hpp"
+#include "Utilities/RingBuffer.hpp"
\ No newline at end of file
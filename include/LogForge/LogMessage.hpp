@@ -0,0 +1,253 @@
+#pragma once
+
+#include "Types.hpp"
+#include "Utilities/Encoding.hpp"
+
+#include <array>
+#include <charconv>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <functional>
+#include <optional>
+#include <type_traits>
+#include <variant>
+
+namespace LogForge
+{
+
+	/// Types of the arguments that can be captured by a DeferredMessage
+	enum class ArgumentType : std::uint8_t
+	{
+		Boolean,
+		Character,
+		Int8,
+		Int16,
+		Int32,
+		Int64,
+		UInt8,
+		UInt16,
+		UInt32,
+		UInt64,
+		Float,
+		Double,
+		Pointer,
+	};
+
+	/// Types that can be captured by value into a DeferredMessage
+	template <typename T>
+	concept DeferredArgument = std::is_arithmetic_v<T> or std::is_enum_v<T> or std::is_same_v<std::remove_cv_t<T>, const void*> or std::is_same_v<std::remove_cv_t<T>, void*>;
+
+	/// Maps an argument type to its type tag and to the type it is stored as
+	template <typename T>
+	struct DeferredArgumentTraits;
+
+	template <typename T> requires std::is_enum_v<T>
+	struct DeferredArgumentTraits<T> : DeferredArgumentTraits<std::underlying_type_t<T>> {};
+
+	template <typename T> requires std::is_pointer_v<T>
+	struct DeferredArgumentTraits<T> { static constexpr auto Type = ArgumentType::Pointer; using Stored = const void*; };
+
+	template <typename T> requires std::same_as<T, bool>
+	struct DeferredArgumentTraits<T> { static constexpr auto Type = ArgumentType::Boolean; using Stored = bool; };
+
+	template <typename T> requires (std::same_as<T, char> or std::same_as<T, wchar_t>)
+	struct DeferredArgumentTraits<T> { static constexpr auto Type = ArgumentType::Character; using Stored = char32_t; };
+
+	template <typename T> requires (std::is_integral_v<T> and not std::same_as<T, bool> and not std::same_as<T, char> and not std::same_as<T, wchar_t>)
+	struct DeferredArgumentTraits<T>
+	{
+		static constexpr auto Type = std::is_signed_v<T>
+			? (sizeof(T) == 1 ? ArgumentType::Int8 : sizeof(T) == 2 ? ArgumentType::Int16 : sizeof(T) == 4 ? ArgumentType::Int32 : ArgumentType::Int64)
+			: (sizeof(T) == 1 ? ArgumentType::UInt8 : sizeof(T) == 2 ? ArgumentType::UInt16 : sizeof(T) == 4 ? ArgumentType::UInt32 : ArgumentType::UInt64);
+		using Stored = T;
+	};
+
+	template <typename T> requires std::same_as<T, float>
+	struct DeferredArgumentTraits<T> { static constexpr auto Type = ArgumentType::Float; using Stored = float; };
+
+	template <typename T> requires (std::same_as<T, double> or std::same_as<T, long double>)
+	struct DeferredArgumentTraits<T> { static constexpr auto Type = ArgumentType::Double; using Stored = double; };
+
+	/// Message that keeps a format string and raw argument bytes and produces its text on demand.
+	///
+	/// The format string is only referenced, so it must have static storage duration
+	/// (usually a string literal). Arguments are copied into a fixed inline buffer
+	/// together with a one-byte type tag each, so building the message never allocates.
+	/// Placeholders are written as `{}`; `{{` and `}}` produce literal braces.
+	class DeferredMessage final
+	{
+	public:
+
+		static constexpr std::size_t MaxArguments = 8;
+		static constexpr std::size_t StorageSize = 64;
+
+		constexpr DeferredMessage() noexcept = default;
+
+		template <DeferredArgument... Args>
+			requires (sizeof...(Args) <= MaxArguments and (sizeof(typename DeferredArgumentTraits<Args>::Stored) + ... + 0) <= StorageSize)
+		explicit DeferredMessage(const Char* format, const Args&... args) noexcept :
+			Format(format),
+			ArgumentCount(static_cast<std::uint8_t>(sizeof...(Args))),
+			ArgumentTypes { DeferredArgumentTraits<Args>::Type... }
+		{
+			std::size_t offset = 0;
+			(Store<Args>(args, offset), ...);
+		}
+
+		/// Appends the formatted text to the given line
+		void FormatTo(Line& output) const
+		{
+			if (Format == nullptr) return;
+
+			std::size_t argument = 0;
+			std::size_t offset = 0;
+
+			for (const Char* current = Format; *current != LOGFORGE_TEXT('\0'); ++current)
+			{
+				if (current[0] == LOGFORGE_TEXT('{') and current[1] == LOGFORGE_TEXT('{'))
+				{
+					output += LOGFORGE_TEXT('{');
+					++current;
+				}
+				else if (current[0] == LOGFORGE_TEXT('}') and current[1] == LOGFORGE_TEXT('}'))
+				{
+					output += LOGFORGE_TEXT('}');
+					++current;
+				}
+				else if (current[0] == LOGFORGE_TEXT('{') and current[1] == LOGFORGE_TEXT('}') and argument < ArgumentCount)
+				{
+					offset = AppendArgument(output, ArgumentTypes[argument++], offset);
+					++current;
+				}
+				else
+				{
+					output += *current;
+				}
+			}
+		}
+
+		[[nodiscard]] Line ToLine() const
+		{
+			Line output;
+			FormatTo(output);
+			return output;
+		}
+
+	private:
+
+		template <typename T>
+		void Store(const T& argument, std::size_t& offset) noexcept
+		{
+			using Stored = typename DeferredArgumentTraits<std::remove_cv_t<T>>::Stored;
+			Stored value;
+			if constexpr (std::is_same_v<std::remove_cv_t<T>, char>)
+			{
+				value = static_cast<Stored>(static_cast<unsigned char>(argument));
+			}
+			else
+			{
+				value = static_cast<Stored>(argument);
+			}
+
+			std::memcpy(Storage.data() + offset, &value, sizeof(Stored));
+			offset += sizeof(Stored);
+		}
+
+		template <typename T>
+		[[nodiscard]] T Load(const std::size_t offset) const noexcept
+		{
+			T value;
+			std::memcpy(&value, Storage.data() + offset, sizeof(T));
+			return value;
+		}
+
+		template <typename T>
+		static void AppendNumber(Line& output, const T value, const int base = 10)
+		{
+			std::array<char, 64> buffer;
+			std::to_chars_result result;
+
+			if constexpr (std::is_floating_point_v<T>)
+			{
+				result = std::to_chars(buffer.data(), buffer.data() + buffer.size(), value);
+			}
+			else
+			{
+				result = std::to_chars(buffer.data(), buffer.data() + buffer.size(), value, base);
+			}
+
+			output.append(buffer.data(), result.ptr);
+		}
+
+		std::size_t AppendArgument(Line& output, const ArgumentType type, const std::size_t offset) const
+		{
+			switch (type)
+			{
+				case ArgumentType::Boolean:		output += Load<bool>(offset) ? LOGFORGE_TEXT("true") : LOGFORGE_TEXT("false"); return offset + sizeof(bool);
+				case ArgumentType::Character:	AppendCodePoint(output, Load<char32_t>(offset)); return offset + sizeof(char32_t);
+				case ArgumentType::Int8:		AppendNumber(output, Load<std::int8_t>(offset)); return offset + sizeof(std::int8_t);
+				case ArgumentType::Int16:		AppendNumber(output, Load<std::int16_t>(offset)); return offset + sizeof(std::int16_t);
+				case ArgumentType::Int32:		AppendNumber(output, Load<std::int32_t>(offset)); return offset + sizeof(std::int32_t);
+				case ArgumentType::Int64:		AppendNumber(output, Load<std::int64_t>(offset)); return offset + sizeof(std::int64_t);
+				case ArgumentType::UInt8:		AppendNumber(output, Load<std::uint8_t>(offset)); return offset + sizeof(std::uint8_t);
+				case ArgumentType::UInt16:		AppendNumber(output, Load<std::uint16_t>(offset)); return offset + sizeof(std::uint16_t);
+				case ArgumentType::UInt32:		AppendNumber(output, Load<std::uint32_t>(offset)); return offset + sizeof(std::uint32_t);
+				case ArgumentType::UInt64:		AppendNumber(output, Load<std::uint64_t>(offset)); return offset + sizeof(std::uint64_t);
+				case ArgumentType::Float:		AppendNumber(output, Load<float>(offset)); return offset + sizeof(float);
+				case ArgumentType::Double:		AppendNumber(output, Load<double>(offset)); return offset + sizeof(double);
+				case ArgumentType::Pointer:
+					output += LOGFORGE_TEXT("0x");
+					AppendNumber(output, reinterpret_cast<std::uintptr_t>(Load<const void*>(offset)), 16);
+					return offset + sizeof(const void*);
+			}
+
+			return offset;
+		}
+
+	public:
+
+		const Char* Format = nullptr;								///< Format string with static storage duration
+		std::uint8_t ArgumentCount = 0;									///< Number of captured arguments
+		std::array<ArgumentType, MaxArguments> ArgumentTypes = {};		///< Type tag of every captured argument
+		std::array<std::byte, StorageSize> Storage = {};				///< Raw bytes of the captured arguments
+
+	};
+
+	/// Message that is produced by a callable only once a printer needs its text.
+	///
+	/// The producer runs at most once; its result is kept for later printers.
+	/// Loggers that hand events to other threads (AsyncLogger) resolve the message
+	/// on the calling thread, so the producer may capture by reference.
+	class LazyMessage final
+	{
+	public:
+
+		template <std::invocable Producer> requires std::convertible_to<std::invoke_result_t<Producer>, Line>
+		LazyMessage(Producer&& producer) :
+			m_Producer(std::forward<Producer>(producer))
+		{}
+
+		/// Runs the producer on first use and returns its result
+		[[nodiscard]] const Line& Resolve() const
+		{
+			if (not m_Line.has_value())
+			{
+				m_Line = m_Producer();
+			}
+
+			return m_Line.value();
+		}
+
+	private:
+
+		std::function<Line()> m_Producer;
+		mutable std::optional<Line> m_Line;
+
+	};
+
+	typedef std::variant<Line, std::exception, DeferredMessage, LazyMessage> LogMessage;
+
+}
@@ -8,8 +8,8 @@ namespace LogForge
 	/// Structure that represents an output event
 	struct OutputEvent
 	{
-		Lines		Lines;	///< Lines of the output event
-		LogEvent	Origin;	///< Origin of the output event
+		LineRange		Lines;	///< Lines of the output event
+		const LogEvent&	Origin;	///< Origin of the output event
 	};
 
 	class LogOutput
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "LogEvent.hpp"
+#include "LineBuffer.hpp"
 
 namespace LogForge
 {
@@ -10,7 +11,17 @@ namespace LogForge
 	public:
 
 		virtual ~LogPrinter() = default;
-		[[nodiscard]] virtual Lines Print(const LogEvent& event) const = 0;
+
+		/// Appends the lines of the event to the output. Decorating printers
+		/// only modify the lines that were added after the call started.
+		virtual void Print(const LogEvent& event, LineBuffer& output) const = 0;
+
+		/// Returns the free space that lines should keep for this printer and the printers it wraps,
+		/// so decorating printers can write their prefixes and suffixes without moving lines
+		[[nodiscard]] virtual LineReserve GetLineReserve() const noexcept
+		{
+			return {};
+		}
 
 	};
 }
\ No newline at end of file
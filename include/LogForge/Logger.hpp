@@ -2,9 +2,23 @@
 
 #include "LogPrinter.hpp"
 
+#include <concepts>
+
 namespace LogForge
 {
 
+	/// Format string of a deferred message together with the location it was written at
+	struct FormatString
+	{
+		FormatString(const Char* format, const SourceLocation& location = std::source_location::current()) noexcept :
+			Format(format),
+			Location(location)
+		{}
+
+		const Char* Format;		///< Format string with static storage duration
+		SourceLocation Location;	///< Source location of the call site
+	};
+
 	class Logger
 	{
 	public:
@@ -12,36 +26,288 @@ namespace LogForge
 		virtual ~Logger() = default;
 		virtual void Log(const LogEvent& event) const = 0;
 
-		void Trace(const LogMessage& message, const TimePoint& time = Clock::now(), const SourceLocation& location = SourceLocation::current()) const
+		/// Returns false if events of the given severity would be rejected anyway.
+		/// The convenience functions below check this before they read the clock or build the event.
+		[[nodiscard]] virtual bool IsEnabled(const Severity severity) const
+		{
+			return IsCompiledIn(severity);
+		}
+
+		template <std::convertible_to<LogMessage> Message>
+		void Trace(Message&& message, const SourceLocation& location = std::source_location::current()) const
+		{
+			LogIfEnabled<Severity::Trace>(std::forward<Message>(message), nullptr, location);
+		}
+
+		template <std::convertible_to<LogMessage> Message>
+		void Trace(Message&& message, const TimePoint& time, const SourceLocation& location = std::source_location::current()) const
+		{
+			LogIfEnabled<Severity::Trace>(std::forward<Message>(message), &time, location);
+		}
+
+		template <std::convertible_to<LogMessage> Message>
+		void Trace(Message&& message, const LogFields& fields, const SourceLocation& location = std::source_location::current()) const
+		{
+			LogIfEnabled<Severity::Trace>(std::forward<Message>(message), nullptr, location, &fields);
+		}
+
+		template <std::convertible_to<LogMessage> Message>
+		void Trace(Message&& message, const TimePoint& time, const LogFields& fields, const SourceLocation& location = std::source_location::current()) const
+		{
+			LogIfEnabled<Severity::Trace>(std::forward<Message>(message), &time, location, &fields);
+		}
+
+		template <DeferredArgument... Args> requires (sizeof...(Args) > 0)
+		void Trace(const FormatString& format, const Args&... args) const
+		{
+			LogFormattedIfEnabled<Severity::Trace>(format, nullptr, args...);
+		}
+
+		template <DeferredArgument... Args> requires (sizeof...(Args) > 0)
+		void Trace(const FormatString& format, const LogFields& fields, const Args&... args) const
+		{
+			LogFormattedIfEnabled<Severity::Trace>(format, &fields, args...);
+		}
+
+		template <std::convertible_to<LogMessage> Message>
+		void Debug(Message&& message, const SourceLocation& location = std::source_location::current()) const
+		{
+			LogIfEnabled<Severity::Debug>(std::forward<Message>(message), nullptr, location);
+		}
+
+		template <std::convertible_to<LogMessage> Message>
+		void Debug(Message&& message, const TimePoint& time, const SourceLocation& location = std::source_location::current()) const
+		{
+			LogIfEnabled<Severity::Debug>(std::forward<Message>(message), &time, location);
+		}
+
+		template <std::convertible_to<LogMessage> Message>
+		void Debug(Message&& message, const LogFields& fields, const SourceLocation& location = std::source_location::current()) const
+		{
+			LogIfEnabled<Severity::Debug>(std::forward<Message>(message), nullptr, location, &fields);
+		}
+
+		template <std::convertible_to<LogMessage> Message>
+		void Debug(Message&& message, const TimePoint& time, const LogFields& fields, const SourceLocation& location = std::source_location::current()) const
+		{
+			LogIfEnabled<Severity::Debug>(std::forward<Message>(message), &time, location, &fields);
+		}
+
+		template <DeferredArgument... Args> requires (sizeof...(Args) > 0)
+		void Debug(const FormatString& format, const Args&... args) const
+		{
+			LogFormattedIfEnabled<Severity::Debug>(format, nullptr, args...);
+		}
+
+		template <DeferredArgument... Args> requires (sizeof...(Args) > 0)
+		void Debug(const FormatString& format, const LogFields& fields, const Args&... args) const
+		{
+			LogFormattedIfEnabled<Severity::Debug>(format, &fields, args...);
+		}
+
+		template <std::convertible_to<LogMessage> Message>
+		void Info(Message&& message, const SourceLocation& location = std::source_location::current()) const
+		{
+			LogIfEnabled<Severity::Info>(std::forward<Message>(message), nullptr, location);
+		}
+
+		template <std::convertible_to<LogMessage> Message>
+		void Info(Message&& message, const TimePoint& time, const SourceLocation& location = std::source_location::current()) const
+		{
+			LogIfEnabled<Severity::Info>(std::forward<Message>(message), &time, location);
+		}
+
+		template <std::convertible_to<LogMessage> Message>
+		void Info(Message&& message, const LogFields& fields, const SourceLocation& location = std::source_location::current()) const
+		{
+			LogIfEnabled<Severity::Info>(std::forward<Message>(message), nullptr, location, &fields);
+		}
+
+		template <std::convertible_to<LogMessage> Message>
+		void Info(Message&& message, const TimePoint& time, const LogFields& fields, const SourceLocation& location = std::source_location::current()) const
+		{
+			LogIfEnabled<Severity::Info>(std::forward<Message>(message), &time, location, &fields);
+		}
+
+		template <DeferredArgument... Args> requires (sizeof...(Args) > 0)
+		void Info(const FormatString& format, const Args&... args) const
 		{
-			Log({ Severity::Trace, message, time, location });
+			LogFormattedIfEnabled<Severity::Info>(format, nullptr, args...);
 		}
 
-		void Debug(const LogMessage& message, const TimePoint& time = Clock::now(), const SourceLocation& location = SourceLocation::current()) const
+		template <DeferredArgument... Args> requires (sizeof...(Args) > 0)
+		void Info(const FormatString& format, const LogFields& fields, const Args&... args) const
 		{
-			Log({ Severity::Debug, message, time, location });
+			LogFormattedIfEnabled<Severity::Info>(format, &fields, args...);
 		}
 
-		void Info(const LogMessage& message, const TimePoint& time = Clock::now(), const SourceLocation& location = SourceLocation::current()) const
+		template <std::convertible_to<LogMessage> Message>
+		void Warning(Message&& message, const SourceLocation& location = std::source_location::current()) const
 		{
-			Log({ Severity::Info, message, time, location });
+			LogIfEnabled<Severity::Warning>(std::forward<Message>(message), nullptr, location);
 		}
 
-		void Warning(const LogMessage& message, const TimePoint& time = Clock::now(), const SourceLocation& location = SourceLocation::current()) const
+		template <std::convertible_to<LogMessage> Message>
+		void Warning(Message&& message, const TimePoint& time, const SourceLocation& location = std::source_location::current()) const
 		{
-			Log({ Severity::Warning, message, time, location });
+			LogIfEnabled<Severity::Warning>(std::forward<Message>(message), &time, location);
 		}
 
-		void Error(const LogMessage& message, const TimePoint& time = Clock::now(), const SourceLocation& location = SourceLocation::current()) const
+		template <std::convertible_to<LogMessage> Message>
+		void Warning(Message&& message, const LogFields& fields, const SourceLocation& location = std::source_location::current()) const
 		{
-			Log({ Severity::Error, message, time, location });
+			LogIfEnabled<Severity::Warning>(std::forward<Message>(message), nullptr, location, &fields);
 		}
 
-		void Fatal(const LogMessage& message, const TimePoint& time = Clock::now(), const SourceLocation& location = SourceLocation::current()) const
+		template <std::convertible_to<LogMessage> Message>
+		void Warning(Message&& message, const TimePoint& time, const LogFields& fields, const SourceLocation& location = std::source_location::current()) const
 		{
-			Log({ Severity::Fatal, message, time, location });
+			LogIfEnabled<Severity::Warning>(std::forward<Message>(message), &time, location, &fields);
+		}
+
+		template <DeferredArgument... Args> requires (sizeof...(Args) > 0)
+		void Warning(const FormatString& format, const Args&... args) const
+		{
+			LogFormattedIfEnabled<Severity::Warning>(format, nullptr, args...);
+		}
+
+		template <DeferredArgument... Args> requires (sizeof...(Args) > 0)
+		void Warning(const FormatString& format, const LogFields& fields, const Args&... args) const
+		{
+			LogFormattedIfEnabled<Severity::Warning>(format, &fields, args...);
+		}
+
+		template <std::convertible_to<LogMessage> Message>
+		void Error(Message&& message, const SourceLocation& location = std::source_location::current()) const
+		{
+			LogIfEnabled<Severity::Error>(std::forward<Message>(message), nullptr, location);
+		}
+
+		template <std::convertible_to<LogMessage> Message>
+		void Error(Message&& message, const TimePoint& time, const SourceLocation& location = std::source_location::current()) const
+		{
+			LogIfEnabled<Severity::Error>(std::forward<Message>(message), &time, location);
+		}
+
+		template <std::convertible_to<LogMessage> Message>
+		void Error(Message&& message, const LogFields& fields, const SourceLocation& location = std::source_location::current()) const
+		{
+			LogIfEnabled<Severity::Error>(std::forward<Message>(message), nullptr, location, &fields);
+		}
+
+		template <std::convertible_to<LogMessage> Message>
+		void Error(Message&& message, const TimePoint& time, const LogFields& fields, const SourceLocation& location = std::source_location::current()) const
+		{
+			LogIfEnabled<Severity::Error>(std::forward<Message>(message), &time, location, &fields);
+		}
+
+		template <DeferredArgument... Args> requires (sizeof...(Args) > 0)
+		void Error(const FormatString& format, const Args&... args) const
+		{
+			LogFormattedIfEnabled<Severity::Error>(format, nullptr, args...);
+		}
+
+		template <DeferredArgument... Args> requires (sizeof...(Args) > 0)
+		void Error(const FormatString& format, const LogFields& fields, const Args&... args) const
+		{
+			LogFormattedIfEnabled<Severity::Error>(format, &fields, args...);
+		}
+
+		template <std::convertible_to<LogMessage> Message>
+		void Fatal(Message&& message, const SourceLocation& location = std::source_location::current()) const
+		{
+			LogIfEnabled<Severity::Fatal>(std::forward<Message>(message), nullptr, location);
+		}
+
+		template <std::convertible_to<LogMessage> Message>
+		void Fatal(Message&& message, const TimePoint& time, const SourceLocation& location = std::source_location::current()) const
+		{
+			LogIfEnabled<Severity::Fatal>(std::forward<Message>(message), &time, location);
+		}
+
+		template <std::convertible_to<LogMessage> Message>
+		void Fatal(Message&& message, const LogFields& fields, const SourceLocation& location = std::source_location::current()) const
+		{
+			LogIfEnabled<Severity::Fatal>(std::forward<Message>(message), nullptr, location, &fields);
+		}
+
+		template <std::convertible_to<LogMessage> Message>
+		void Fatal(Message&& message, const TimePoint& time, const LogFields& fields, const SourceLocation& location = std::source_location::current()) const
+		{
+			LogIfEnabled<Severity::Fatal>(std::forward<Message>(message), &time, location, &fields);
+		}
+
+		template <DeferredArgument... Args> requires (sizeof...(Args) > 0)
+		void Fatal(const FormatString& format, const Args&... args) const
+		{
+			LogFormattedIfEnabled<Severity::Fatal>(format, nullptr, args...);
+		}
+
+		template <DeferredArgument... Args> requires (sizeof...(Args) > 0)
+		void Fatal(const FormatString& format, const LogFields& fields, const Args&... args) const
+		{
+			LogFormattedIfEnabled<Severity::Fatal>(format, &fields, args...);
+		}
+
+	private:
+
+		template <Severity EventSeverity, typename Message>
+		void LogIfEnabled(Message&& message, const TimePoint* time, const SourceLocation& location, const LogFields* fields = nullptr) const
+		{
+			if constexpr (IsCompiledIn(EventSeverity))
+			{
+				if (not IsEnabled(EventSeverity)) return;
+
+				// Deliberately not const. GCC initializes the constant members of a braced event
+				// separately from the others and clears all of the event before, including the
+				// inline storage of its fields, while a variable is simply stored with the rest.
+				auto severity = EventSeverity;
+
+				if (fields != nullptr)
+				{
+					Log({ severity, LogMessage(std::forward<Message>(message)), time != nullptr ? *time : Clock::now(), location, *fields });
+				}
+				else
+				{
+					Log({ severity, LogMessage(std::forward<Message>(message)), time != nullptr ? *time : Clock::now(), location });
+				}
+			}
+		}
+
+		template <Severity EventSeverity, typename... Args>
+		void LogFormattedIfEnabled(const FormatString& format, const LogFields* fields, const Args&... args) const
+		{
+			if constexpr (IsCompiledIn(EventSeverity))
+			{
+				if (not IsEnabled(EventSeverity)) return;
+
+				// Not const for the same reason as in LogIfEnabled
+				auto severity = EventSeverity;
+
+				if (fields != nullptr)
+				{
+					Log({ severity, DeferredMessage(format.Format, args...), Clock::now(), format.Location, *fields });
+				}
+				else
+				{
+					Log({ severity, DeferredMessage(format.Format, args...), Clock::now(), format.Location });
+				}
+			}
 		}
 
 	};
 
-}
\ No newline at end of file
+}
+
+/// Logs through the given logger only if the severity is compiled in.
+/// Unlike calling the member functions directly, the arguments are not even evaluated
+/// for severities below LOGFORGE_MIN_SEVERITY, so no code is generated for the call.
+#define LOGFORGE_LOG(severity, logger, ...) \
+	do { if constexpr (::LogForge::IsCompiledIn(::LogForge::Severity::severity)) { (logger).severity(__VA_ARGS__); } } while (false)
+
+#define LOGFORGE_TRACE(logger, ...) LOGFORGE_LOG(Trace, logger, __VA_ARGS__)
+#define LOGFORGE_DEBUG(logger, ...) LOGFORGE_LOG(Debug, logger, __VA_ARGS__)
+#define LOGFORGE_INFO(logger, ...) LOGFORGE_LOG(Info, logger, __VA_ARGS__)
+#define LOGFORGE_WARNING(logger, ...) LOGFORGE_LOG(Warning, logger, __VA_ARGS__)
+#define LOGFORGE_ERROR(logger, ...) LOGFORGE_LOG(Error, logger, __VA_ARGS__)
+#define LOGFORGE_FATAL(logger, ...) LOGFORGE_LOG(Fatal, logger, __VA_ARGS__)
@@ -0,0 +1,246 @@
+#pragma once
+
+#include "../Logger.hpp"
+#include "../Utilities/RingBuffer.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <exception>
+#include <thread>
+
+namespace LogForge
+{
+
+	/// Structure that represents a snapshot of the counters of an AsyncLogger
+	struct AsyncLoggerStatistics
+	{
+		std::uint64_t Enqueued;		///< Events accepted into the queue
+		std::uint64_t Dropped;		///< Events rejected because the queue was full, or lost because the real logger threw
+		std::uint64_t Processed;	///< Events handed to the real logger
+	};
+
+	/// Logger that queues events and lets a background thread pass them to the real logger.
+	///
+	/// Callers only copy the event into a bounded lock-free ring, so filtering,
+	/// printing and output happen on the worker thread. Events that do not fit
+	/// into the ring are dropped and counted.
+	///
+	/// Only IsEnabled() is checked on the calling thread. Lazy messages have to be
+	/// resolved there as well, since their producers may capture locals by
+	/// reference; this happens once the event has a slot, so dropped events never
+	/// run their producer, but before the filter of the real logger sees the event
+	/// on the worker. If a producer throws, the exception reaches the caller and
+	/// the event is skipped. An exception thrown by the real
+	/// logger is caught on the worker and the event is counted as dropped. The
+	/// destructor drains the queue before it joins the worker.
+	template <std::derived_from<Logger> InnerLogger>
+	class AsyncLogger final : public Logger
+	{
+	public:
+
+		static constexpr std::size_t DefaultCapacity = RingBuffer<LogEvent>::DefaultCapacity;
+
+		explicit AsyncLogger(InnerLogger logger, const std::size_t capacity = DefaultCapacity) :
+			RealLogger(std::move(logger)),
+			m_Queue(capacity),
+			m_Worker([this] { Run(); })
+		{}
+
+		AsyncLogger(const AsyncLogger&) = delete;
+		AsyncLogger& operator = (const AsyncLogger&) = delete;
+
+		~AsyncLogger() override
+		{
+			m_Stopping.store(true, std::memory_order_seq_cst);
+			WakeWorker();
+			m_Worker.join();
+		}
+
+		void Log(const LogEvent& event) const override
+		{
+			if (not IsEnabled(event.Severity)) return;
+			Enqueue(event);
+		}
+
+		[[nodiscard]] bool IsEnabled(const Severity severity) const override
+		{
+			return RealLogger.IsEnabled(severity);
+		}
+
+		/// Blocks until every event enqueued before this call has been handed to the real logger
+		void Flush() const
+		{
+			// Counting published events is not enough: another producer may have claimed an earlier slot
+			// and not published it yet, and the worker pops in slot order. Every slot that was claimed
+			// before this call is popped once m_Processed reaches the claim position.
+			const auto target = static_cast<std::uint64_t>(m_Queue.GetClaimed());
+
+			m_FlushWaiters.fetch_add(1, std::memory_order_seq_cst);
+			WakeWorker();
+
+			for (auto processed = m_Processed.load(std::memory_order_seq_cst); processed < target; processed = m_Processed.load(std::memory_order_seq_cst))
+			{
+				m_Processed.wait(processed, std::memory_order_acquire);
+			}
+
+			m_FlushWaiters.fetch_sub(1, std::memory_order_relaxed);
+		}
+
+		[[nodiscard]] AsyncLoggerStatistics GetStatistics() const noexcept
+		{
+			return {
+				.Enqueued = m_Enqueued.load(std::memory_order_relaxed),
+				.Dropped = m_Dropped.load(std::memory_order_relaxed),
+				.Processed = m_Processed.load(std::memory_order_relaxed)
+			};
+		}
+
+		[[nodiscard]] std::size_t Capacity() const noexcept
+		{
+			return m_Queue.Capacity();
+		}
+
+	private:
+
+		/// Number of events after which waiting Flush() calls are notified while the queue is still busy
+		static constexpr std::uint64_t FlushNotifyInterval = 64;
+
+		/// Event in a slot of the queue
+		struct QueuedEvent
+		{
+			LogEvent Event;
+			bool Skipped = false;	///< Set if resolving the message threw, so there is nothing to log
+		};
+
+		void Enqueue(const LogEvent& event) const
+		{
+			std::exception_ptr exception;
+
+			const bool pushed = m_Queue.TryPushWith([&event, &exception](QueuedEvent& queued)
+			{
+				// The slot is claimed at this point and has to be published in any case, or the worker would wait for it forever
+				try
+				{
+					AssignDetached(queued.Event, event);
+					queued.Skipped = false;
+				}
+				catch (...)
+				{
+					queued.Skipped = true;
+					exception = std::current_exception();
+				}
+			});
+
+			if (not pushed)
+			{
+				m_Dropped.fetch_add(1, std::memory_order_relaxed);
+				return;
+			}
+
+			if (exception == nullptr) m_Enqueued.fetch_add(1, std::memory_order_release);
+
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			if (m_WorkerSleeping.load(std::memory_order_relaxed))
+			{
+				WakeWorker();
+			}
+
+			if (exception != nullptr) std::rethrow_exception(exception);
+		}
+
+		void Run()
+		{
+			for (;;)
+			{
+				const auto signal = m_Signal.load(std::memory_order_acquire);
+				if (Drain() > 0) continue;
+
+				if (m_Stopping.load(std::memory_order_acquire))
+				{
+					Drain();
+					return;
+				}
+
+				m_WorkerSleeping.store(true, std::memory_order_relaxed);
+				std::atomic_thread_fence(std::memory_order_seq_cst);
+
+				if (m_Queue.IsEmpty() and not m_Stopping.load(std::memory_order_relaxed))
+				{
+					m_Signal.wait(signal, std::memory_order_acquire);
+				}
+
+				m_WorkerSleeping.store(false, std::memory_order_relaxed);
+			}
+		}
+
+		std::size_t Drain()
+		{
+			std::size_t drained = 0;
+			while (m_Queue.TryPop([this](const QueuedEvent& queued) { if (not queued.Skipped) LogCaught(queued.Event); }))
+			{
+				const auto processed = m_Processed.fetch_add(1, std::memory_order_seq_cst) + 1;
+				++drained;
+
+				if (processed % FlushNotifyInterval == 0)
+				{
+					NotifyFlushWaiters();
+				}
+			}
+
+			if (drained > 0)
+			{
+				NotifyFlushWaiters();
+			}
+
+			return drained;
+		}
+
+		/// Passes the event to the real logger. An exception must not leave the worker, which would terminate the process.
+		void LogCaught(const LogEvent& event) noexcept
+		{
+			try
+			{
+				RealLogger.Log(event);
+			}
+			catch (...)
+			{
+				m_Dropped.fetch_add(1, std::memory_order_relaxed);
+			}
+		}
+
+		void NotifyFlushWaiters()
+		{
+			if (m_FlushWaiters.load(std::memory_order_seq_cst) > 0)
+			{
+				m_Processed.notify_all();
+			}
+		}
+
+		void WakeWorker() const
+		{
+			m_Signal.fetch_add(1, std::memory_order_release);
+			m_Signal.notify_one();
+		}
+
+	public:
+
+		InnerLogger RealLogger;
+
+	private:
+
+		mutable RingBuffer<QueuedEvent> m_Queue;
+
+		mutable std::atomic<std::uint64_t> m_Enqueued = 0;
+		mutable std::atomic<std::uint64_t> m_Dropped = 0;
+		std::atomic<std::uint64_t> m_Processed = 0;
+
+		mutable std::atomic<std::uint32_t> m_Signal = 0;
+		mutable std::atomic<std::uint32_t> m_FlushWaiters = 0;
+		std::atomic<bool> m_WorkerSleeping = false;
+		std::atomic<bool> m_Stopping = false;
+
+		std::thread m_Worker;
+
+	};
+
+}
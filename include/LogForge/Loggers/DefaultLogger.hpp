@@ -5,6 +5,10 @@
 #include "../LogFilter.hpp"
 #include "../Logger.hpp"
 
+#include <array>
+#include <cstddef>
+#include <optional>
+
 namespace LogForge
 {
 
@@ -24,8 +28,23 @@ namespace LogForge
 		{
 			if (LogFilter.Filter(event))
 			{
+				// Logging can nest on the same thread: a lazy message, a suppression reporter or an output
+				// may log while this event is being printed or written. Every nesting level renders into a
+				// buffer of its own, so the lines of the inner event never end up in the outer one. Levels
+				// beyond the reused buffers get a fresh one.
+				thread_local std::array<LineBuffer, ReusedBufferCount> buffers;
+				thread_local std::size_t depth = 0;
+
+				std::optional<LineBuffer> nestedBuffer;
+				auto& buffer = depth < buffers.size() ? buffers[depth] : nestedBuffer.emplace();
+				const NestingScope scope(depth);
+
+				buffer.Clear();
+				buffer.SetLineReserve(LogPrinter.GetLineReserve());
+				LogPrinter.Print(event, buffer);
+
 				const auto outputEvent = OutputEvent {
-					.Lines = LogPrinter.Print(event),
+					.Lines = buffer.GetLines(),
 					.Origin = event
 				};
 
@@ -33,6 +52,28 @@ namespace LogForge
 			}
 		}
 
+		[[nodiscard]] bool IsEnabled(const Severity severity) const override
+		{
+			return LogFilter.IsEnabled(severity);
+		}
+
+	private:
+
+		/// Nesting levels per thread whose line buffers are kept between events
+		static constexpr std::size_t ReusedBufferCount = 4;
+
+		/// Counts a nesting level for as long as it exists, also while an exception unwinds it
+		struct NestingScope
+		{
+			explicit NestingScope(std::size_t& depth) noexcept : Depth(depth) { ++Depth; }
+			~NestingScope() { --Depth; }
+
+			NestingScope(const NestingScope&) = delete;
+			NestingScope& operator = (const NestingScope&) = delete;
+
+			std::size_t& Depth;
+		};
+
 	public:
 
 		Filter LogFilter;
@@ -0,0 +1,356 @@
+#pragma once
+
+#include "../LogOutput.hpp"
+#include "../Utilities/BinaryFormat.hpp"
+#include "../Utilities/CallSiteMap.hpp"
+#include "FlushPolicy.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace LogForge
+{
+
+	/// Output that writes events in a compact binary format instead of text.
+	///
+	/// The rendered lines are ignored: every event is stored as a severity byte, the
+	/// time as a varint delta to the previous event, a call site ID, the message and its fields.
+	/// Deferred messages keep their raw argument bytes and refer to their format
+	/// string by ID, so logging neither formats nor renders anything. Pair it with the
+	/// Nothing() printer to skip rendering entirely. File names, function names and
+	/// format strings go into a string table that is written once per file, the first
+	/// time they are used. BinaryDecoder turns the file back into events that any
+	/// printer chain can render; the layout is described at BinaryRecord.
+	///
+	/// Strings are identified by their content, so every distinct text is defined once
+	/// no matter where it is stored. The address of the last text seen at a place is
+	/// remembered as well, so a format string or field key that is used again is only
+	/// compared with it instead of being encoded and hashed for every event.
+	class BinaryOutput final : public LogOutput
+	{
+	public:
+
+		static constexpr std::size_t DefaultBufferSize = 64 * 1024;
+
+		/// Opens or creates the file at the given path for appending. Check IsOpen() for the result.
+		explicit BinaryOutput(const char* path, const LogForge::FlushPolicy flushPolicy = FlushPolicy::PerEvent(), const std::size_t bufferSize = DefaultBufferSize) :
+			BinaryOutput(std::make_unique<std::ofstream>(path, std::ios::binary | std::ios::app), flushPolicy, bufferSize)
+		{}
+
+		/// Writes to the given stream, which must be opened in binary mode and outlive the output
+		explicit BinaryOutput(std::ostream& stream, const LogForge::FlushPolicy flushPolicy = FlushPolicy::PerEvent(), const std::size_t bufferSize = DefaultBufferSize) :
+			FlushPolicy(flushPolicy),
+			m_Stream(&stream),
+			m_BufferSize(bufferSize)
+		{
+			m_Buffer.reserve(m_BufferSize);
+			AppendHeader();
+		}
+
+		BinaryOutput(BinaryOutput&& other) noexcept :
+			FlushPolicy(other.FlushPolicy),
+			m_OwnedStream(std::move(other.m_OwnedStream)),
+			m_Stream(std::exchange(other.m_Stream, nullptr)),
+			m_BufferSize(other.m_BufferSize),
+			m_Buffer(std::move(other.m_Buffer)),
+			m_Strings(std::move(other.m_Strings)),
+			m_StringsByAddress(std::move(other.m_StringsByAddress)),
+			m_CallSites(std::move(other.m_CallSites)),
+			m_LastTime(other.m_LastTime),
+			m_LastFlush(other.m_LastFlush)
+		{}
+
+		BinaryOutput(const BinaryOutput&) = delete;
+		BinaryOutput& operator = (const BinaryOutput&) = delete;
+		BinaryOutput& operator = (BinaryOutput&&) = delete;
+
+		~BinaryOutput() override
+		{
+			if (m_Stream != nullptr) Flush();
+		}
+
+		void Output(const OutputEvent& event) const override
+		{
+			const auto& origin = event.Origin;
+			const auto callSite = GetCallSite(origin.SourceLocation);
+
+			const auto time = std::chrono::duration_cast<std::chrono::nanoseconds>(origin.Time.time_since_epoch()).count();
+			const auto delta = EncodeZigZag(static_cast<std::int64_t>(time) - m_LastTime);
+			m_LastTime = static_cast<std::int64_t>(time);
+
+			// Keys have to be defined before the event that uses them, just like the format string
+			const auto flags = origin.Fields.IsEmpty() ? std::uint8_t(0) : BinaryFieldsFlag;
+			m_FieldKeys.clear();
+			for (const auto& field : origin.Fields)
+			{
+				m_FieldKeys.push_back(GetString(field.Key));
+			}
+
+			std::visit([&]<typename T>(const T& message)
+			{
+				if constexpr (std::is_same_v<T, DeferredMessage>)
+				{
+					if (message.Format == nullptr)
+					{
+						AppendEventStart(BinaryMessageKind::Text, flags, origin.Severity, delta, callSite);
+						AppendVarint(m_Buffer, 0);
+						return;
+					}
+
+					// The format string has to be defined before the event that uses it
+					const auto format = GetString(message.Format);
+
+					AppendEventStart(BinaryMessageKind::Deferred, flags, origin.Severity, delta, callSite);
+					AppendVarint(m_Buffer, format);
+					AppendArguments(message);
+				}
+				else if constexpr (std::is_same_v<T, std::exception>)
+				{
+					AppendEventStart(BinaryMessageKind::Exception, flags, origin.Severity, delta, callSite);
+					const std::string_view what = message.what();
+					AppendVarint(m_Buffer, what.size());
+					m_Buffer += what;
+				}
+				else
+				{
+					AppendEventStart(BinaryMessageKind::Text, flags, origin.Severity, delta, callSite);
+
+					if constexpr (std::is_same_v<T, LazyMessage>)
+					{
+						AppendText(message.Resolve());
+					}
+					else
+					{
+						AppendText(message);
+					}
+				}
+			}, origin.Message);
+
+			if (flags != 0)
+			{
+				AppendFields(origin.Fields);
+			}
+
+			if (m_Buffer.size() >= m_BufferSize or FlushPolicy.IsDue(origin.Severity, m_Buffer.size(), m_LastFlush))
+			{
+				Flush();
+			}
+		}
+
+		/// Writes everything that is buffered and flushes the stream. Returns false if the stream failed.
+		bool Flush() const
+		{
+			if (not m_Buffer.empty())
+			{
+				m_Stream->write(m_Buffer.data(), static_cast<std::streamsize>(m_Buffer.size()));
+				m_Buffer.clear();
+			}
+
+			m_Stream->flush();
+
+			if (FlushPolicy.Interval.count() > 0)
+			{
+				m_LastFlush = std::chrono::steady_clock::now();
+			}
+
+			return m_Stream->good();
+		}
+
+		[[nodiscard]] bool IsOpen() const noexcept
+		{
+			return m_Stream != nullptr and m_Stream->good();
+		}
+
+	private:
+
+		BinaryOutput(std::unique_ptr<std::ofstream> stream, const LogForge::FlushPolicy flushPolicy, const std::size_t bufferSize) :
+			BinaryOutput(*stream, flushPolicy, bufferSize)
+		{
+			m_OwnedStream = std::move(stream);
+		}
+
+		void AppendHeader() const
+		{
+			m_Buffer += static_cast<char>(BinaryRecord::Header);
+			m_Buffer.append(BinaryMagic.begin(), BinaryMagic.end());
+			m_Buffer += static_cast<char>(BinaryFormatVersion);
+			m_Buffer += static_cast<char>(BinaryNativeByteOrder);
+		}
+
+		void AppendEventStart(const BinaryMessageKind kind, const std::uint8_t flags, const Severity severity, const std::uint64_t delta, const std::uint32_t callSite) const
+		{
+			m_Buffer += static_cast<char>(flags | static_cast<std::uint8_t>(kind) << 3 | static_cast<std::uint8_t>(severity));
+			AppendVarint(m_Buffer, delta);
+			AppendVarint(m_Buffer, callSite);
+		}
+
+		void AppendText(const LineView text) const
+		{
+			m_Scratch.clear();
+			AppendUtf8(m_Scratch, text);
+			AppendVarint(m_Buffer, m_Scratch.size());
+			m_Buffer += m_Scratch;
+		}
+
+		void AppendArguments(const DeferredMessage& message) const
+		{
+			m_Buffer += static_cast<char>(message.ArgumentCount);
+			for (std::size_t i = 0; i < message.ArgumentCount; ++i)
+			{
+				m_Buffer += static_cast<char>(message.ArgumentTypes[i]);
+			}
+
+			if constexpr (sizeof(const void*) == 8)
+			{
+				// Stored exactly like the binary format, so the bytes are copied in one go
+				std::size_t size = 0;
+				for (std::size_t i = 0; i < message.ArgumentCount; ++i) size += GetBinaryArgumentSize(message.ArgumentTypes[i]);
+
+				m_Buffer.append(reinterpret_cast<const char*>(message.Storage.data()), size);
+			}
+			else
+			{
+				std::size_t offset = 0;
+				for (std::size_t i = 0; i < message.ArgumentCount; ++i)
+				{
+					if (message.ArgumentTypes[i] == ArgumentType::Pointer)
+					{
+						const void* pointer;
+						std::memcpy(&pointer, message.Storage.data() + offset, sizeof(pointer));
+
+						const auto address = static_cast<std::uint64_t>(reinterpret_cast<std::uintptr_t>(pointer));
+						m_Buffer.append(reinterpret_cast<const char*>(&address), sizeof(address));
+						offset += sizeof(pointer);
+					}
+					else
+					{
+						const auto size = GetBinaryArgumentSize(message.ArgumentTypes[i]);
+						m_Buffer.append(reinterpret_cast<const char*>(message.Storage.data() + offset), size);
+						offset += size;
+					}
+				}
+			}
+		}
+
+		/// Appends the fields with the key IDs that were collected before the event started
+		void AppendFields(const LogFields& fields) const
+		{
+			AppendVarint(m_Buffer, fields.Size());
+
+			std::size_t index = 0;
+			for (const auto& field : fields)
+			{
+				AppendVarint(m_Buffer, m_FieldKeys[index++]);
+				m_Buffer += static_cast<char>(field.Type);
+
+				switch (field.Type)
+				{
+					case FieldType::Boolean:	m_Buffer += static_cast<char>(field.Boolean ? 1 : 0); break;
+					case FieldType::Int:		AppendVarint(m_Buffer, EncodeZigZag(field.Int)); break;
+					case FieldType::UInt:		AppendVarint(m_Buffer, field.UInt); break;
+					case FieldType::Float:		m_Buffer.append(reinterpret_cast<const char*>(&field.Float), sizeof(field.Float)); break;
+					case FieldType::String:		AppendText(field.Text); break;
+				}
+			}
+		}
+
+		/// Returns the ID of the call site and defines it and its strings on first use
+		[[nodiscard]] std::uint32_t GetCallSite(const SourceLocation& location) const
+		{
+			const auto key = CallSiteKey::FromLocation(location);
+			if (const auto found = m_CallSites.find(key); found != m_CallSites.end()) return found->second;
+
+			m_Scratch = key.File;
+			const auto file = DefineString();
+			m_Scratch = key.Function;
+			const auto function = DefineString();
+			const auto id = static_cast<std::uint32_t>(m_CallSites.size());
+			m_CallSites.emplace(key, id);
+
+			m_Buffer += static_cast<char>(BinaryRecord::CallSite);
+			AppendVarint(m_Buffer, id);
+			AppendVarint(m_Buffer, file);
+			AppendVarint(m_Buffer, function);
+			AppendVarint(m_Buffer, key.LineNumber);
+			AppendVarint(m_Buffer, key.ColumnNumber);
+			return id;
+		}
+
+		/// Returns the ID of the text, checking the text last seen at the same address first
+		[[nodiscard]] std::uint32_t GetString(const LineView text) const
+		{
+			auto& cached = m_StringsByAddress[text.data()];
+			if (cached.Id != NoString and cached.Text == text) return cached.Id;
+
+			m_Scratch.clear();
+			AppendUtf8(m_Scratch, text);
+
+			cached.Text = text;
+			cached.Id = DefineString();
+			return cached.Id;
+		}
+
+		/// Returns the ID of the UTF-8 text in the scratch buffer and defines it on first use
+		[[nodiscard]] std::uint32_t DefineString() const
+		{
+			const auto [entry, inserted] = m_Strings.try_emplace(m_Scratch, static_cast<std::uint32_t>(m_Strings.size()));
+			if (not inserted) return entry->second;
+
+			m_Buffer += static_cast<char>(BinaryRecord::String);
+			AppendVarint(m_Buffer, entry->second);
+			AppendVarint(m_Buffer, m_Scratch.size());
+			m_Buffer += m_Scratch;
+			return entry->second;
+		}
+
+		static constexpr std::uint32_t NoString = std::numeric_limits<std::uint32_t>::max();
+
+		/// Text that was last looked up at an address, and its ID
+		struct CachedString
+		{
+			Line Text;
+			std::uint32_t Id = NoString;
+		};
+
+		struct CallSiteHash
+		{
+			[[nodiscard]] std::size_t operator () (const CallSiteKey& key) const noexcept
+			{
+				return key.Hash();
+			}
+		};
+
+	public:
+
+		LogForge::FlushPolicy FlushPolicy;
+
+	private:
+
+		std::unique_ptr<std::ofstream> m_OwnedStream;
+		std::ostream* m_Stream;
+		std::size_t m_BufferSize;
+		mutable std::string m_Buffer;
+		mutable std::string m_Scratch;
+		mutable std::vector<std::uint32_t> m_FieldKeys;
+		mutable std::unordered_map<std::string, std::uint32_t> m_Strings;
+		mutable std::unordered_map<const void*, CachedString> m_StringsByAddress;
+		mutable std::unordered_map<CallSiteKey, std::uint32_t, CallSiteHash> m_CallSites;
+		mutable std::int64_t m_LastTime = 0;
+		mutable std::chrono::steady_clock::time_point m_LastFlush = std::chrono::steady_clock::now();
+
+	};
+
+}
@@ -0,0 +1,269 @@
+#pragma once
+
+#include "../LogOutput.hpp"
+#include "../Utilities/Encoding.hpp"
+#include "FlushPolicy.hpp"
+
+#ifndef _WIN32
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+namespace LogForge
+{
+
+	/// Output that writes lines as UTF-8 straight to a POSIX file descriptor, bypassing iostreams.
+	///
+	/// Events are encoded into a byte buffer owned by the output and written with
+	/// one writev per flush, so a buffering FlushPolicy combines a whole batch of
+	/// events into a single system call. In UTF-8 builds, events that are flushed
+	/// right away are written straight out of the LineBuffer without copying.
+	/// Partial writes are continued and writes interrupted by signals are retried.
+	///
+	/// Files are opened with O_APPEND, so other processes may append to the same file.
+	/// Failed writes drop their text and are reported by GetLastError().
+	/// Not available on Windows.
+	class FileOutput final : public LogOutput
+	{
+	public:
+
+		static constexpr std::size_t DefaultBufferSize = 64 * 1024;
+
+		/// Opens or creates the file at the given path for appending. Check IsOpen() for the result.
+		explicit FileOutput(const char* path, const LogForge::FlushPolicy flushPolicy = FlushPolicy::PerEvent(), const std::size_t bufferSize = DefaultBufferSize) :
+			FileOutput(::open(path, O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644), true, flushPolicy, bufferSize)
+		{
+			if (m_Descriptor < 0) m_LastError = errno;
+		}
+
+		/// Writes to the standard output, which stays open when the output is destroyed
+		[[nodiscard]] static FileOutput StandardOutput(const LogForge::FlushPolicy flushPolicy = FlushPolicy::PerEvent(), const std::size_t bufferSize = DefaultBufferSize)
+		{
+			return FileOutput(STDOUT_FILENO, false, flushPolicy, bufferSize);
+		}
+
+		/// Writes to the standard error, which stays open when the output is destroyed
+		[[nodiscard]] static FileOutput StandardError(const LogForge::FlushPolicy flushPolicy = FlushPolicy::PerEvent(), const std::size_t bufferSize = DefaultBufferSize)
+		{
+			return FileOutput(STDERR_FILENO, false, flushPolicy, bufferSize);
+		}
+
+		FileOutput(FileOutput&& other) noexcept :
+			FlushPolicy(other.FlushPolicy),
+			m_Descriptor(std::exchange(other.m_Descriptor, -1)),
+			m_OwnsDescriptor(other.m_OwnsDescriptor),
+			m_BufferSize(other.m_BufferSize),
+			m_Size(other.m_Size),
+			m_Buffer(std::move(other.m_Buffer)),
+			m_LastFlush(other.m_LastFlush),
+			m_LastError(other.m_LastError)
+		{}
+
+		FileOutput(const FileOutput&) = delete;
+		FileOutput& operator = (const FileOutput&) = delete;
+		FileOutput& operator = (FileOutput&&) = delete;
+
+		~FileOutput() override
+		{
+			if (m_Descriptor < 0) return;
+
+			Flush();
+			if (m_OwnsDescriptor) ::close(m_Descriptor);
+		}
+
+		void Output(const OutputEvent& event) const override
+		{
+			if (m_Descriptor < 0) return;
+
+			if constexpr (sizeof(Char) == 1)
+			{
+				if (event.Lines.size() * 2 < MaxVectors)
+				{
+					std::size_t size = 0;
+					for (const auto& line : event.Lines) size += line.size() + 1;
+
+					const auto unflushed = m_Buffer.size() + size;
+					if (unflushed >= m_BufferSize or FlushPolicy.IsDue(event.Origin.Severity, unflushed, m_LastFlush))
+					{
+						m_Size += size;
+						WriteDirect(event.Lines);
+						return;
+					}
+				}
+			}
+
+			const auto previousSize = m_Buffer.size();
+			for (const auto& line : event.Lines)
+			{
+				AppendUtf8(m_Buffer, line);
+				m_Buffer += '\n';
+			}
+
+			m_Size += m_Buffer.size() - previousSize;
+
+			if (m_Buffer.size() >= m_BufferSize or FlushPolicy.IsDue(event.Origin.Severity, m_Buffer.size(), m_LastFlush))
+			{
+				Flush();
+			}
+		}
+
+		/// Writes everything that is buffered. Returns false if the write failed.
+		bool Flush() const
+		{
+			if (m_Buffer.empty()) return true;
+
+			m_Vectors.clear();
+			m_Vectors.push_back({ m_Buffer.data(), m_Buffer.size() });
+			return Write();
+		}
+
+		/// Writes what is buffered to the current descriptor, closes it if it is owned and continues with the given one.
+		/// The new descriptor is owned by the output from now on.
+		void ReplaceDescriptor(const int descriptor)
+		{
+			if (m_Descriptor >= 0)
+			{
+				Flush();
+				if (m_OwnsDescriptor) ::close(m_Descriptor);
+			}
+
+			m_Descriptor = descriptor;
+			m_OwnsDescriptor = true;
+			m_Size = GetFileSize(descriptor);
+		}
+
+		/// Returns the size of the file including text that is still buffered
+		[[nodiscard]] std::uint64_t GetSize() const noexcept
+		{
+			return m_Size;
+		}
+
+		[[nodiscard]] bool IsOpen() const noexcept
+		{
+			return m_Descriptor >= 0;
+		}
+
+		/// Returns the errno of the last failed open or write, or 0 if nothing failed
+		[[nodiscard]] int GetLastError() const noexcept
+		{
+			return m_LastError;
+		}
+
+	private:
+
+	#if defined(IOV_MAX)
+		static constexpr std::size_t MaxVectors = IOV_MAX;
+	#else
+		static constexpr std::size_t MaxVectors = 16;
+	#endif
+
+		FileOutput(const int descriptor, const bool ownsDescriptor, const LogForge::FlushPolicy flushPolicy, const std::size_t bufferSize) :
+			FlushPolicy(flushPolicy),
+			m_Descriptor(descriptor),
+			m_OwnsDescriptor(ownsDescriptor),
+			m_BufferSize(std::max(bufferSize, std::size_t(1))),
+			m_Size(GetFileSize(descriptor))
+		{
+			m_Buffer.reserve(m_BufferSize);
+		}
+
+		[[nodiscard]] static std::uint64_t GetFileSize(const int descriptor) noexcept
+		{
+			struct stat status = {};
+			if (descriptor < 0 or ::fstat(descriptor, &status) != 0 or not S_ISREG(status.st_mode)) return 0;
+
+			return static_cast<std::uint64_t>(status.st_size);
+		}
+
+		/// Writes the buffered text followed by the lines of an event in one call
+		void WriteDirect(const LineRange& lines) const
+		{
+			static constexpr char lineBreak = '\n';
+
+			m_Vectors.clear();
+			if (not m_Buffer.empty()) m_Vectors.push_back({ m_Buffer.data(), m_Buffer.size() });
+
+			for (const auto& line : lines)
+			{
+				m_Vectors.push_back({ const_cast<Char*>(line.data()), line.size() });
+				m_Vectors.push_back({ const_cast<char*>(&lineBreak), 1 });
+			}
+
+			Write();
+		}
+
+		/// Writes all of m_Vectors and empties the buffer, even if the write failed
+		bool Write() const
+		{
+			auto* current = m_Vectors.data();
+			auto remaining = m_Vectors.size();
+			bool succeeded = true;
+
+			while (remaining > 0)
+			{
+				const auto written = ::writev(m_Descriptor, current, static_cast<int>(std::min(remaining, MaxVectors)));
+				if (written < 0 and errno == EINTR) continue;
+				if (written <= 0 and (written < 0 or current->iov_len > 0))
+				{
+					m_LastError = written < 0 ? errno : EIO;
+					succeeded = false;
+					break;
+				}
+
+				// Skip the vectors that were written completely and continue a partially written one
+				auto count = static_cast<std::size_t>(written);
+				while (remaining > 0 and count >= current->iov_len)
+				{
+					count -= current->iov_len;
+					++current;
+					--remaining;
+				}
+
+				if (remaining > 0)
+				{
+					current->iov_base = static_cast<char*>(current->iov_base) + count;
+					current->iov_len -= count;
+				}
+			}
+
+			m_Buffer.clear();
+			if (FlushPolicy.Interval.count() > 0)
+			{
+				m_LastFlush = std::chrono::steady_clock::now();
+			}
+
+			return succeeded;
+		}
+
+	public:
+
+		LogForge::FlushPolicy FlushPolicy;
+
+	private:
+
+		int m_Descriptor;
+		bool m_OwnsDescriptor;
+		std::size_t m_BufferSize;
+		mutable std::uint64_t m_Size;
+		mutable std::string m_Buffer;
+		mutable std::vector<iovec> m_Vectors;
+		mutable std::chrono::steady_clock::time_point m_LastFlush = std::chrono::steady_clock::now();
+		mutable int m_LastError = 0;
+
+	};
+
+}
+
+#endif
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "../Severity.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <optional>
+
+namespace LogForge
+{
+
+	/// Structure that decides when an output flushes the text it has buffered.
+	/// All enabled conditions are combined; the output is flushed if any of them applies.
+	struct FlushPolicy
+	{
+		bool EveryEvent = false;						///< Flush after every event
+		std::size_t Characters = 0;						///< Flush once this many characters were written since the last flush (0 disables)
+		std::chrono::milliseconds Interval = {};		///< Flush the first event after this much time has passed since the last flush (0 disables)
+		std::optional<Severity> MinSeverity = {};		///< Always flush events of this severity or above
+
+		/// Leaves flushing to the output itself
+		[[nodiscard]] static constexpr FlushPolicy Never() noexcept
+		{
+			return {};
+		}
+
+		[[nodiscard]] static constexpr FlushPolicy PerEvent() noexcept
+		{
+			return { .EveryEvent = true };
+		}
+
+		[[nodiscard]] static constexpr FlushPolicy PerCharacters(const std::size_t characters) noexcept
+		{
+			return { .Characters = characters };
+		}
+
+		[[nodiscard]] static constexpr FlushPolicy PerInterval(const std::chrono::milliseconds interval) noexcept
+		{
+			return { .Interval = interval };
+		}
+
+		[[nodiscard]] static constexpr FlushPolicy FromSeverity(const Severity minSeverity) noexcept
+		{
+			return { .MinSeverity = minSeverity };
+		}
+
+		/// Returns true if an event of the given severity has to be flushed, given the amount of
+		/// text that is waiting including the event. Only the interval condition reads the clock.
+		[[nodiscard]] bool IsDue(const Severity severity, const std::size_t unflushed, const std::chrono::steady_clock::time_point lastFlush) const
+		{
+			if (EveryEvent) return true;
+			if (MinSeverity.has_value() and severity >= MinSeverity.value()) return true;
+			if (Characters > 0 and unflushed >= Characters) return true;
+
+			return Interval.count() > 0 and unflushed > 0 and std::chrono::steady_clock::now() - lastFlush >= Interval;
+		}
+	};
+
+}
@@ -0,0 +1,293 @@
+#pragma once
+
+#include "../LogOutput.hpp"
+#include "../Utilities/Encoding.hpp"
+
+#ifndef _WIN32
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace LogForge
+{
+
+	/// Output that copies events straight into a memory mapping of the log file.
+	///
+	/// The file is preallocated and mapped one window at a time. Writing an event is
+	/// a copy into the mapping without a system call; the kernel writes the pages
+	/// back on its own, and since they are in the page cache, events written before
+	/// the process crashes are not lost. Once half of a window is used, the next one
+	/// is allocated and mapped ahead of time, so moving on to it is cheap.
+	///
+	/// The file only gets its real size when the output is destroyed. After a crash
+	/// it ends in zero bytes up to the end of the last window, which readers have to
+	/// skip. The file must not be truncated while it is mapped.
+	///
+	/// If a window cannot be allocated or mapped, events are written with pwrite
+	/// instead, so none are lost, and mapping is tried again with the first event
+	/// that is at least a second later. Not available on Windows.
+	class MappedFileOutput final : public LogOutput
+	{
+	public:
+
+		static constexpr std::size_t DefaultWindowSize = 16 * 1024 * 1024;
+
+		/// Opens or creates the file at the given path and continues behind its current end. Check IsOpen() for the result.
+		explicit MappedFileOutput(const char* path, const std::size_t windowSize = DefaultWindowSize) :
+			m_Mapping(std::make_unique<Mapping>(path, windowSize))
+		{}
+
+		MappedFileOutput(MappedFileOutput&&) noexcept = default;
+		MappedFileOutput(const MappedFileOutput&) = delete;
+		MappedFileOutput& operator = (const MappedFileOutput&) = delete;
+		MappedFileOutput& operator = (MappedFileOutput&&) = delete;
+
+		void Output(const OutputEvent& event) const override
+		{
+			if (m_Mapping->Current.Data == nullptr) m_Mapping->Remap(event.Origin.Time);
+
+			for (const auto& line : event.Lines)
+			{
+				if constexpr (sizeof(Char) == 1)
+				{
+					m_Mapping->Append(reinterpret_cast<const char*>(line.data()), line.size());
+				}
+				else
+				{
+					m_Mapping->Scratch.clear();
+					AppendUtf8(m_Mapping->Scratch, line);
+					m_Mapping->Append(m_Mapping->Scratch.data(), m_Mapping->Scratch.size());
+				}
+
+				m_Mapping->Append("\n", 1);
+			}
+		}
+
+		/// Starts writing back what was written since the last flush without waiting for it. Returns false if that or a write failed.
+		bool Flush() const
+		{
+			return m_Mapping->Flush();
+		}
+
+		[[nodiscard]] bool IsOpen() const noexcept
+		{
+			return m_Mapping->Descriptor >= 0;
+		}
+
+		/// Returns the errno of the last failed open, allocation, mapping or write, or 0 if nothing failed
+		[[nodiscard]] int GetLastError() const noexcept
+		{
+			return m_Mapping->LastError;
+		}
+
+	private:
+
+		/// Time after a failed mapping before the next attempt
+		static constexpr std::chrono::seconds RetryDelay = std::chrono::seconds(1);
+
+		/// Mapped range of the file
+		struct Window
+		{
+			char* Data = nullptr;
+			std::uint64_t Offset = 0;
+		};
+
+		/// The file and its windows. They live on the heap, so moving the output does not move them.
+		struct Mapping
+		{
+			Mapping(const char* path, const std::size_t windowSize)
+			{
+				PageSize = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+				WindowSize = std::max((windowSize + PageSize - 1) / PageSize * PageSize, PageSize);
+
+				Descriptor = ::open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+				if (Descriptor < 0)
+				{
+					LastError = errno;
+					return;
+				}
+
+				struct stat status = {};
+				if (::fstat(Descriptor, &status) == 0) Position = static_cast<std::uint64_t>(status.st_size);
+
+				Current = Map(Position / PageSize * PageSize);
+				Flushed = Position;
+			}
+
+			Mapping(const Mapping&) = delete;
+			Mapping& operator = (const Mapping&) = delete;
+
+			~Mapping()
+			{
+				if (Descriptor < 0) return;
+
+				Unmap(Current);
+				Unmap(Next);
+
+				// Drop the preallocated space behind the last event
+				if (::ftruncate(Descriptor, static_cast<off_t>(Position)) != 0) LastError = errno;
+				::close(Descriptor);
+			}
+
+			/// Copies bytes into the mapping, moving on to the next window when the current one is full
+			void Append(const char* data, std::size_t size)
+			{
+				if (Descriptor < 0) return;
+
+				while (size > 0)
+				{
+					if (Current.Data == nullptr)
+					{
+						Write(data, size);
+						return;
+					}
+
+					const auto end = Current.Offset + WindowSize;
+					const auto count = std::min<std::uint64_t>(size, end - Position);
+					std::memcpy(Current.Data + (Position - Current.Offset), data, count);
+
+					Position += count;
+					data += count;
+					size -= count;
+
+					if (Next.Data == nullptr and not NextFailed and Position - Current.Offset >= WindowSize / 2)
+					{
+						Next = Map(end);
+						NextFailed = Next.Data == nullptr;
+					}
+
+					if (Position == end)
+					{
+						Unmap(Current);
+						Current = Next.Data != nullptr ? Next : Map(end);
+						Next = {};
+						NextFailed = false;
+					}
+				}
+			}
+
+			/// Writes bytes with pwrite while no window is mapped
+			void Write(const char* data, std::size_t size)
+			{
+				while (size > 0)
+				{
+					const auto written = ::pwrite(Descriptor, data, size, static_cast<off_t>(Position));
+					if (written < 0 and errno == EINTR) continue;
+					if (written <= 0)
+					{
+						LastError = written < 0 ? errno : EIO;
+						WriteFailed = true;
+						return;
+					}
+
+					Position += static_cast<std::uint64_t>(written);
+					data += written;
+					size -= static_cast<std::size_t>(written);
+				}
+			}
+
+			/// Maps the window around the current position again, unless the last attempt was too recent
+			void Remap(const TimePoint& time)
+			{
+				if (Descriptor < 0 or time < RetryAfter) return;
+
+				Current = Map(Position / PageSize * PageSize);
+				RetryAfter = Current.Data == nullptr ? time + RetryDelay : TimePoint();
+			}
+
+			bool Flush()
+			{
+				if (Descriptor < 0) return false;
+
+				const auto succeeded = not WriteFailed;
+				WriteFailed = false;
+
+				// Only the pages written since the last flush are passed on; text written with pwrite is in the page cache already
+				if (Current.Data != nullptr and Position > Current.Offset)
+				{
+					const auto begin = std::max(Flushed, Current.Offset) / PageSize * PageSize;
+					if (::msync(Current.Data + (begin - Current.Offset), Position - begin, MS_ASYNC) != 0)
+					{
+						LastError = errno;
+						return false;
+					}
+				}
+
+				Flushed = Position;
+				return succeeded;
+			}
+
+			/// Allocates the file up to the end of the window at the given offset and maps it
+			[[nodiscard]] Window Map(const std::uint64_t offset)
+			{
+				if (not Allocate(offset + WindowSize)) return {};
+
+				int flags = MAP_SHARED;
+			#ifdef MAP_POPULATE
+				flags |= MAP_POPULATE;
+			#endif
+
+				void* data = ::mmap(nullptr, WindowSize, PROT_READ | PROT_WRITE, flags, Descriptor, static_cast<off_t>(offset));
+				if (data == MAP_FAILED)
+				{
+					LastError = errno;
+					return {};
+				}
+
+				return { static_cast<char*>(data), offset };
+			}
+
+			/// Makes sure the file has blocks up to the given size, so writing to the mapping cannot run out of space
+			[[nodiscard]] bool Allocate(const std::uint64_t size)
+			{
+			#ifdef __linux__
+				if (::fallocate(Descriptor, 0, 0, static_cast<off_t>(size)) == 0) return true;
+			#endif
+
+				// Without fallocate the file is only extended; the blocks are allocated when pages are written back
+				struct stat status = {};
+				if (::fstat(Descriptor, &status) == 0 and static_cast<std::uint64_t>(status.st_size) >= size) return true;
+				if (::ftruncate(Descriptor, static_cast<off_t>(size)) == 0) return true;
+
+				LastError = errno;
+				return false;
+			}
+
+			void Unmap(Window& window) noexcept
+			{
+				if (window.Data != nullptr) ::munmap(window.Data, WindowSize);
+				window = {};
+			}
+
+			int Descriptor = -1;
+			std::size_t PageSize = 0;
+			std::size_t WindowSize = 0;
+			std::uint64_t Position = 0;		///< Position in the file behind the last byte that was written
+			std::uint64_t Flushed = 0;		///< Position up to which Flush() was called
+			Window Current;
+			Window Next;
+			bool NextFailed = false;
+			bool WriteFailed = false;
+			TimePoint RetryAfter = {};
+			std::string Scratch;
+			int LastError = 0;
+		};
+
+		std::unique_ptr<Mapping> m_Mapping;
+
+	};
+
+}
+
+#endif
@@ -1,12 +1,66 @@
 #pragma once
 
 #include "../LogOutput.hpp"
+#include "../Utilities/RingBuffer.hpp"
 
-#include <vector>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
 #include <memory>
+#include <thread>
+#include <vector>
 
 namespace LogForge
 {
+
+	/// Enumeration that decides what a queued sink does with an event that does not fit into its queue
+	enum class OverflowPolicy
+	{
+		Block,	///< Wait until the worker of the sink has made room
+		Drop,	///< Discard the event for this sink
+		Spill	///< Hand the event to the sink named by SinkOptions::SpillTarget, or drop it if that one is full as well
+	};
+
+	/// Structure that configures the queue of one sink of a MultiOutput
+	struct SinkOptions
+	{
+		std::size_t Capacity = 1024;				///< Events the queue holds, rounded up to a power of two
+		OverflowPolicy Overflow = OverflowPolicy::Block;	///< What happens to events that do not fit into the queue
+		std::size_t SpillTarget = NoSpillTarget;		///< Index of the output that receives spilled events, in the vector given to the MultiOutput
+
+		static constexpr std::size_t NoSpillTarget = std::numeric_limits<std::size_t>::max();
+	};
+
+	/// Structure that represents a snapshot of the counters of one sink of a MultiOutput
+	struct SinkStatistics
+	{
+		std::uint64_t Enqueued;		///< Events accepted into the queue, including events spilled here by other sinks
+		std::uint64_t Written;		///< Events handed to the output
+		std::uint64_t Dropped;		///< Events this sink discarded because its queue was full, or lost because its output threw
+		std::uint64_t Spilled;		///< Events this sink handed to its spill target because its queue was full
+
+		/// Returns the number of events that are queued but not written yet
+		[[nodiscard]] constexpr std::uint64_t GetLag() const noexcept
+		{
+			return Enqueued - Written;
+		}
+	};
+
+	/// Output that passes every event to a list of outputs.
+	///
+	/// By default the outputs are called one after another on the logging thread.
+	/// When SinkOptions are given, every output gets its own bounded lock-free queue
+	/// and worker thread instead: the logging thread only copies the lines into each
+	/// queue, so a slow output neither holds up the others nor the caller. What
+	/// happens when a queue is full is chosen per sink, and the counters of each
+	/// sink can be read at any time with GetStatistics().
+	///
+	/// Queued sinks may be fed from several threads at once. Every sink writes its
+	/// events in the order they were enqueued; events of different sinks are not
+	/// ordered against each other. An exception thrown by a queued output is caught
+	/// on its worker and the event is counted as dropped. The destructor writes
+	/// everything that is queued.
 	class MultiOutput final : public LogOutput
 	{
 	public:
@@ -15,16 +69,293 @@ namespace LogForge
 			m_Outputs(NormalizeOutputs(std::move(outputs)))
 		{}
 
+		/// Constructor that gives every output a queue and a worker thread.
+		/// The options apply to the output at the same index; outputs without options use the defaults.
+		MultiOutput(std::vector<std::unique_ptr<LogOutput>> outputs, const std::vector<SinkOptions>& options)
+		{
+			std::vector<std::size_t> indices(outputs.size(), SinkOptions::NoSpillTarget);
+			m_Sinks.reserve(outputs.size());
+
+			for (std::size_t i = 0; i < outputs.size(); ++i)
+			{
+				if (not outputs[i]) continue;
+
+				indices[i] = m_Sinks.size();
+				m_Sinks.push_back(std::make_unique<Sink>(std::move(outputs[i]), i < options.size() ? options[i] : SinkOptions()));
+			}
+
+			for (const auto& sink : m_Sinks)
+			{
+				const auto target = sink->Options.SpillTarget;
+				if (target >= indices.size() or indices[target] == SinkOptions::NoSpillTarget) continue;
+				if (m_Sinks[indices[target]] != sink) sink->SpillTarget = m_Sinks[indices[target]].get();
+			}
+		}
+
 		void Output(const OutputEvent& event) const override
 		{
-			for (const auto& output : m_Outputs)
+			if (m_Sinks.empty())
+			{
+				for (const auto& output : m_Outputs)
+				{
+					output->Output(event);
+				}
+
+				return;
+			}
+
+			// Producers may capture locals by reference, so they have to run before the caller returns
+			if (const auto* lazyMessage = std::get_if<LazyMessage>(&event.Origin.Message))
+			{
+				(void)lazyMessage->Resolve();
+			}
+
+			for (const auto& sink : m_Sinks)
+			{
+				sink->Output(event);
+			}
+		}
+
+		/// Blocks until every event queued before this call has been handed to its output
+		void Flush() const
+		{
+			for (const auto& sink : m_Sinks)
 			{
-				output->Output(event);
+				sink->Flush();
 			}
 		}
 
+		/// Returns true if the outputs are fed through queues
+		[[nodiscard]] bool IsQueued() const noexcept
+		{
+			return not m_Sinks.empty();
+		}
+
+		[[nodiscard]] std::size_t GetSinkCount() const noexcept
+		{
+			return IsQueued() ? m_Sinks.size() : m_Outputs.size();
+		}
+
+		/// Returns the counters of the sink at the given index. They are all zero if the outputs are not queued.
+		[[nodiscard]] SinkStatistics GetStatistics(const std::size_t index) const noexcept
+		{
+			return IsQueued() ? m_Sinks[index]->GetStatistics() : SinkStatistics {};
+		}
+
 	private:
 
+		/// Copy of an event that waits in the queue of a sink
+		struct QueuedEvent
+		{
+			LineBuffer Lines;
+			LogEvent Origin;
+		};
+
+		/// Output together with its queue and worker. It lives on the heap, so moving the MultiOutput does not move it.
+		class Sink final
+		{
+		public:
+
+			Sink(std::unique_ptr<LogOutput> output, const SinkOptions& options) :
+				Options(options),
+				m_Output(std::move(output)),
+				m_Queue(options.Capacity),
+				m_Worker([this] { Run(); })
+			{}
+
+			Sink(const Sink&) = delete;
+			Sink& operator = (const Sink&) = delete;
+
+			~Sink()
+			{
+				m_Stopping.store(true, std::memory_order_seq_cst);
+				WakeWorker();
+				m_Worker.join();
+			}
+
+			void Output(const OutputEvent& event)
+			{
+				if (TryEnqueue(event)) return;
+
+				switch (Options.Overflow)
+				{
+				case OverflowPolicy::Block:
+					EnqueueBlocking(event);
+					return;
+
+				case OverflowPolicy::Spill:
+					if (SpillTarget != nullptr and SpillTarget->TryEnqueue(event))
+					{
+						m_Spilled.fetch_add(1, std::memory_order_relaxed);
+						return;
+					}
+
+					[[fallthrough]];
+
+				case OverflowPolicy::Drop:
+					m_Dropped.fetch_add(1, std::memory_order_relaxed);
+					return;
+				}
+			}
+
+			[[nodiscard]] bool TryEnqueue(const OutputEvent& event)
+			{
+				const bool pushed = m_Queue.TryPushWith([this, &event](QueuedEvent& queued)
+				{
+					// Reuses the memory the slot kept from its previous event
+					queued.Lines.Clear();
+					for (const auto& line : event.Lines)
+					{
+						queued.Lines.AddLine(line);
+					}
+
+					AssignDetached(queued.Origin, event.Origin);
+
+					// Counted before the event is published, so the lag never drops below zero
+					m_Enqueued.fetch_add(1, std::memory_order_relaxed);
+				});
+
+				if (not pushed) return false;
+
+				std::atomic_thread_fence(std::memory_order_seq_cst);
+				if (m_WorkerSleeping.load(std::memory_order_relaxed))
+				{
+					WakeWorker();
+				}
+
+				return true;
+			}
+
+			void Flush() const
+			{
+				// Counting enqueued events is not enough: another producer may have claimed an earlier slot
+				// and not filled it yet, and the worker pops in slot order. Every slot that was claimed
+				// before this call is written once m_Written reaches the claim position.
+				const auto target = static_cast<std::uint64_t>(m_Queue.GetClaimed());
+
+				m_Waiters.fetch_add(1, std::memory_order_seq_cst);
+				WakeWorker();
+
+				for (auto written = m_Written.load(std::memory_order_seq_cst); written < target; written = m_Written.load(std::memory_order_seq_cst))
+				{
+					m_Written.wait(written, std::memory_order_acquire);
+				}
+
+				m_Waiters.fetch_sub(1, std::memory_order_relaxed);
+			}
+
+			[[nodiscard]] SinkStatistics GetStatistics() const noexcept
+			{
+				const auto written = m_Written.load(std::memory_order_acquire);
+
+				return {
+					.Enqueued = m_Enqueued.load(std::memory_order_acquire),
+					.Written = written,
+					.Dropped = m_Dropped.load(std::memory_order_relaxed),
+					.Spilled = m_Spilled.load(std::memory_order_relaxed)
+				};
+			}
+
+			const SinkOptions Options;
+			Sink* SpillTarget = nullptr;
+
+		private:
+
+			/// Waits for the worker to free a slot for every attempt that fails
+			void EnqueueBlocking(const OutputEvent& event)
+			{
+				m_Waiters.fetch_add(1, std::memory_order_seq_cst);
+
+				for (;;)
+				{
+					const auto written = m_Written.load(std::memory_order_seq_cst);
+					if (TryEnqueue(event)) break;
+
+					m_Written.wait(written, std::memory_order_acquire);
+				}
+
+				m_Waiters.fetch_sub(1, std::memory_order_relaxed);
+			}
+
+			void Run()
+			{
+				for (;;)
+				{
+					const auto signal = m_Signal.load(std::memory_order_acquire);
+					if (Drain() > 0) continue;
+
+					if (m_Stopping.load(std::memory_order_acquire))
+					{
+						Drain();
+						return;
+					}
+
+					m_WorkerSleeping.store(true, std::memory_order_relaxed);
+					std::atomic_thread_fence(std::memory_order_seq_cst);
+
+					if (m_Queue.IsEmpty() and not m_Stopping.load(std::memory_order_relaxed))
+					{
+						m_Signal.wait(signal, std::memory_order_acquire);
+					}
+
+					m_WorkerSleeping.store(false, std::memory_order_relaxed);
+				}
+			}
+
+			std::size_t Drain()
+			{
+				std::size_t drained = 0;
+				while (m_Queue.TryPop([this](const QueuedEvent& queued) { OutputCaught(queued); }))
+				{
+					m_Written.fetch_add(1, std::memory_order_seq_cst);
+					++drained;
+
+					// Blocked producers wait for every single slot, so they are notified right away
+					if (m_Waiters.load(std::memory_order_seq_cst) > 0)
+					{
+						m_Written.notify_all();
+					}
+				}
+
+				return drained;
+			}
+
+			/// Passes the event to the output. An exception must not leave the worker, which would terminate the process.
+			void OutputCaught(const QueuedEvent& queued) noexcept
+			{
+				try
+				{
+					m_Output->Output({ queued.Lines.GetLines(), queued.Origin });
+				}
+				catch (...)
+				{
+					m_Dropped.fetch_add(1, std::memory_order_relaxed);
+				}
+			}
+
+			void WakeWorker() const
+			{
+				m_Signal.fetch_add(1, std::memory_order_release);
+				m_Signal.notify_one();
+			}
+
+			std::unique_ptr<LogOutput> m_Output;
+			RingBuffer<QueuedEvent> m_Queue;
+
+			std::atomic<std::uint64_t> m_Enqueued = 0;
+			std::atomic<std::uint64_t> m_Written = 0;
+			std::atomic<std::uint64_t> m_Dropped = 0;
+			std::atomic<std::uint64_t> m_Spilled = 0;
+
+			mutable std::atomic<std::uint32_t> m_Signal = 0;
+			mutable std::atomic<std::uint32_t> m_Waiters = 0;
+			std::atomic<bool> m_WorkerSleeping = false;
+			std::atomic<bool> m_Stopping = false;
+
+			std::thread m_Worker;
+
+		};
+
 		static std::vector<std::unique_ptr<LogOutput>> NormalizeOutputs(std::vector<std::unique_ptr<LogOutput>> outputs)
 		{
 			std::vector<std::unique_ptr<LogOutput>> normalizedOutputs;
@@ -42,6 +373,7 @@ namespace LogForge
 		}
 
 		std::vector<std::unique_ptr<LogOutput>> m_Outputs;
+		std::vector<std::unique_ptr<Sink>> m_Sinks;
 
 	};
-}
\ No newline at end of file
+}
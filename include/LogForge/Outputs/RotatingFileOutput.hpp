@@ -0,0 +1,274 @@
+#pragma once
+
+#include "FileOutput.hpp"
+
+#ifndef _WIN32
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace LogForge
+{
+
+	/// Structure that decides when a RotatingFileOutput starts a new file.
+	/// If both conditions are enabled, whichever comes first starts the next file.
+	struct RotationPolicy
+	{
+		std::uint64_t MaxSize = 0;				///< Start a new file once the current one reaches this many bytes (0 disables)
+		std::chrono::seconds Interval = {};		///< Start a new file at every multiple of this interval since 1970-01-01 UTC (0 disables)
+		std::size_t MaxArchives = 5;			///< Number of previous files that are kept as `path.1` (newest) to `path.N`, 0 replaces the file with an empty one
+	};
+
+	/// Output that writes to a file like FileOutput and starts a new file by size or time.
+	///
+	/// When a rollover is due, a helper thread deletes the oldest archive, renames
+	/// the others and the current file, and opens a new file under the original path.
+	/// The logging thread never waits for it: it keeps appending to the file it has
+	/// open, which by then is the newest archive, and switches to the new file with
+	/// the first event after the helper is done. Without archives, the helper opens
+	/// the empty file under a temporary name and only renames it over the path after
+	/// the logging thread has switched to it, so no event goes to an unlinked file.
+	/// The interval is checked against the time of the events, so it does not read a clock.
+	///
+	/// Not available on Windows.
+	class RotatingFileOutput final : public LogOutput
+	{
+	public:
+
+		explicit RotatingFileOutput(
+			std::string path,
+			const LogForge::RotationPolicy rotationPolicy,
+			const LogForge::FlushPolicy flushPolicy = FlushPolicy::PerEvent(),
+			const std::size_t bufferSize = FileOutput::DefaultBufferSize
+		) :
+			RotationPolicy(rotationPolicy),
+			m_File(path.c_str(), flushPolicy, bufferSize),
+			m_Rollover(std::make_unique<Rollover>(std::move(path), rotationPolicy.MaxArchives)),
+			m_Helper([rollover = m_Rollover.get()] { rollover->Run(); }),
+			m_NextRollover(GetNextRollover(Clock::now()))
+		{}
+
+		RotatingFileOutput(RotatingFileOutput&&) noexcept = default;
+		RotatingFileOutput(const RotatingFileOutput&) = delete;
+		RotatingFileOutput& operator = (const RotatingFileOutput&) = delete;
+		RotatingFileOutput& operator = (RotatingFileOutput&&) = delete;
+
+		~RotatingFileOutput() override
+		{
+			if (m_Rollover == nullptr) return;
+
+			m_Rollover->Stopping.store(true, std::memory_order_release);
+			m_Rollover->Wake();
+			m_Helper.join();
+
+			// A file that was opened after the last event is not needed anymore
+			if (const auto descriptor = m_Rollover->NextDescriptor.exchange(-1); descriptor >= 0)
+			{
+				::close(descriptor);
+				// Unless the last rename failed and events still go to the temporary file
+				if (RotationPolicy.MaxArchives == 0 and m_Rollover->LastError.load(std::memory_order_relaxed) == 0) std::remove(m_Rollover->GetReplacementPath().c_str());
+			}
+		}
+
+		void Output(const OutputEvent& event) const override
+		{
+			if (m_Pending and m_Rollover->Completed.load(std::memory_order_acquire))
+			{
+				Switch(event.Origin.Time);
+			}
+
+			m_File.Output(event);
+
+			if (not m_Pending and IsDue(event.Origin.Time))
+			{
+				m_Pending = true;
+				m_NextRollover = GetNextRollover(event.Origin.Time);
+				m_Rollover->Requested.store(true, std::memory_order_release);
+				m_Rollover->Wake();
+			}
+		}
+
+		/// Writes everything that is buffered. Returns false if the write failed.
+		bool Flush() const
+		{
+			return m_File.Flush();
+		}
+
+		/// Returns the errno of the last failed write or rollover, or 0 if nothing failed.
+		/// A failed rollover is forgotten once a later one succeeds.
+		[[nodiscard]] int GetLastError() const noexcept
+		{
+			const auto rolloverError = m_Rollover->LastError.load(std::memory_order_relaxed);
+			return rolloverError != 0 ? rolloverError : m_File.GetLastError();
+		}
+
+	private:
+
+		/// Time after a failed rollover before the next attempt
+		static constexpr std::chrono::seconds RetryDelay = std::chrono::seconds(1);
+
+		/// State shared with the helper thread. It lives on the heap, so moving the output does not move it.
+		struct Rollover
+		{
+			Rollover(std::string path, const std::size_t maxArchives) :
+				Path(std::move(path)),
+				MaxArchives(maxArchives)
+			{}
+
+			void Run()
+			{
+				for (;;)
+				{
+					const auto signal = Signal.load(std::memory_order_acquire);
+
+					// Done even when stopping, so the last replacement does not keep its temporary name
+					Install();
+					if (Stopping.load(std::memory_order_acquire)) return;
+
+					if (Requested.exchange(false, std::memory_order_acq_rel))
+					{
+						const auto descriptor = Roll();
+						LastError.store(descriptor < 0 ? errno : 0, std::memory_order_relaxed);
+
+						NextDescriptor.store(descriptor, std::memory_order_relaxed);
+						Completed.store(true, std::memory_order_release);
+						continue;
+					}
+
+					Signal.wait(signal, std::memory_order_acquire);
+				}
+			}
+
+			/// Moves the current file and its archives one step back and opens a new current file.
+			/// Without archives, it only opens the empty file that replaces the current one.
+			[[nodiscard]] int Roll()
+			{
+				if (MaxArchives == 0)
+				{
+					// The previous replacement must have its final name before the temporary one is truncated
+					Install();
+					return ::open(GetReplacementPath().c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_APPEND | O_CLOEXEC, 0644);
+				}
+
+				// Archives are only shifted up to the first free slot, so retrying
+				// after a failed rename does not delete another archive.
+				auto firstFree = std::size_t(1);
+				while (firstFree < MaxArchives and ::access(GetArchivePath(firstFree).c_str(), F_OK) == 0) ++firstFree;
+
+				if (firstFree == MaxArchives) std::remove(GetArchivePath(MaxArchives).c_str());
+				for (auto archive = firstFree; archive > 1; --archive)
+				{
+					if (std::rename(GetArchivePath(archive - 1).c_str(), GetArchivePath(archive).c_str()) != 0) return -1;
+				}
+
+				if (std::rename(Path.c_str(), GetArchivePath(1).c_str()) != 0) return -1;
+				return ::open(Path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+			}
+
+			/// Renames the replacement over the current file once the logging thread writes to it
+			void Install()
+			{
+				if (not Installing.exchange(false, std::memory_order_acq_rel)) return;
+				if (std::rename(GetReplacementPath().c_str(), Path.c_str()) != 0) LastError.store(errno, std::memory_order_relaxed);
+			}
+
+			[[nodiscard]] std::string GetArchivePath(const std::size_t archive) const
+			{
+				return archive == 0 ? Path : Path + '.' + std::to_string(archive);
+			}
+
+			/// Temporary name of the file that replaces the current one when no archives are kept
+			[[nodiscard]] std::string GetReplacementPath() const
+			{
+				return Path + ".tmp";
+			}
+
+			void Wake()
+			{
+				Signal.fetch_add(1, std::memory_order_release);
+				Signal.notify_one();
+			}
+
+			const std::string Path;
+			const std::size_t MaxArchives;
+
+			std::atomic<std::uint32_t> Signal = 0;
+			std::atomic<bool> Requested = false;
+			std::atomic<bool> Completed = false;
+			std::atomic<bool> Installing = false;
+			std::atomic<bool> Stopping = false;
+			std::atomic<int> NextDescriptor = -1;
+			std::atomic<int> LastError = 0;
+		};
+
+		/// Continues with the file the helper opened, or retries later if it failed
+		void Switch(const TimePoint& time) const
+		{
+			m_Rollover->Completed.store(false, std::memory_order_relaxed);
+			m_Pending = false;
+
+			const auto descriptor = m_Rollover->NextDescriptor.exchange(-1, std::memory_order_relaxed);
+			if (descriptor >= 0)
+			{
+				m_File.ReplaceDescriptor(descriptor);
+				m_RetryAfter = {};
+
+				// The replacement only takes the place of the current file once nothing is written to that anymore
+				if (RotationPolicy.MaxArchives == 0)
+				{
+					m_Rollover->Installing.store(true, std::memory_order_release);
+					m_Rollover->Wake();
+				}
+			}
+			else
+			{
+				m_RetryAfter = time + RetryDelay;
+			}
+		}
+
+		[[nodiscard]] bool IsDue(const TimePoint& time) const noexcept
+		{
+			if (time < m_RetryAfter) return false;
+			if (RotationPolicy.MaxSize > 0 and m_File.GetSize() >= RotationPolicy.MaxSize) return true;
+
+			return RotationPolicy.Interval.count() > 0 and time >= m_NextRollover;
+		}
+
+		[[nodiscard]] TimePoint GetNextRollover(const TimePoint& time) const noexcept
+		{
+			if (RotationPolicy.Interval.count() <= 0) return TimePoint::max();
+
+			const auto intervals = std::chrono::floor<std::chrono::seconds>(time).time_since_epoch() / RotationPolicy.Interval;
+			return TimePoint(RotationPolicy.Interval * (intervals + 1));
+		}
+
+	public:
+
+		const LogForge::RotationPolicy RotationPolicy;
+
+	private:
+
+		mutable FileOutput m_File;
+		std::unique_ptr<Rollover> m_Rollover;
+		std::thread m_Helper;
+
+		mutable bool m_Pending = false;
+		mutable TimePoint m_NextRollover;
+		mutable TimePoint m_RetryAfter = {};
+
+	};
+
+}
+
+#endif
@@ -1,30 +1,65 @@
 #pragma once
 
 #include "../LogOutput.hpp"
+#include "FlushPolicy.hpp"
 
+#include <chrono>
+#include <cstddef>
 #include <ostream>
 
 namespace LogForge
 {
+
+	/// Output that writes every line followed by a line break to a stream.
+	///
+	/// Lines go into the stream's buffer; the FlushPolicy decides when the stream
+	/// is flushed. Only the interval condition reads a clock, and it is checked
+	/// when an event arrives, so text can stay buffered while nothing is logged.
 	class StreamOutput final : public LogOutput
 	{
 	public:
 
-		explicit StreamOutput(std::wostream& stream) noexcept :
+		explicit StreamOutput(OutputStream& stream, const LogForge::FlushPolicy flushPolicy = FlushPolicy::PerEvent()) noexcept :
+			FlushPolicy(flushPolicy),
 			m_Stream(&stream)
 		{}
-		
+
 		void Output(const OutputEvent& event) const override
 		{
 			for (const auto& line : event.Lines)
 			{
-				*m_Stream << line << std::endl;
+				m_Stream->write(line.data(), static_cast<std::streamsize>(line.size()));
+				m_Stream->put(LOGFORGE_TEXT('\n'));
+				m_Unflushed += line.size() + 1;
+			}
+
+			if (FlushPolicy.IsDue(event.Origin.Severity, m_Unflushed, m_LastFlush))
+			{
+				Flush();
+			}
+		}
+
+		/// Flushes the stream regardless of the policy
+		void Flush() const
+		{
+			m_Stream->flush();
+			m_Unflushed = 0;
+
+			if (FlushPolicy.Interval.count() > 0)
+			{
+				m_LastFlush = std::chrono::steady_clock::now();
 			}
 		}
 
+	public:
+
+		LogForge::FlushPolicy FlushPolicy;
+
 	private:
 
-		std::wostream* m_Stream;
+		OutputStream* m_Stream;
+		mutable std::size_t m_Unflushed = 0;
+		mutable std::chrono::steady_clock::time_point m_LastFlush = std::chrono::steady_clock::now();
 
 	};
 }
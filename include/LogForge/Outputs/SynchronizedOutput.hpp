@@ -0,0 +1,271 @@
+#pragma once
+
+#include "../LogOutput.hpp"
+#include "FlushPolicy.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace LogForge
+{
+
+	/// Output that lets any number of threads log through a single output.
+	///
+	/// Every thread stages its rendered events in one of several shards, each with
+	/// its own lock, instead of going to the output right away. When the batch
+	/// policy says a shard is due, the output is locked once and all events of
+	/// that shard are written in one go; any other shard whose lock is free at that
+	/// moment is written along with it. Threads are spread over the shards, so they
+	/// rarely wait for each other and the lock of the output is taken once per batch.
+	///
+	/// Events of one thread are written in the order they were logged, and the lines
+	/// of an event are never interleaved with other events. Events of different threads
+	/// are written in batches, so they can appear out of order relative to their time.
+	/// Staged events are written by Flush() and by the destructor.
+	///
+	/// If the batch policy has an interval, a helper thread wakes up once per interval
+	/// and writes the shards that are older than that, so events of threads that
+	/// stopped logging are written within about two intervals. After every batch the
+	/// inner output is flushed if it has a Flush() function, so it should be given
+	/// FlushPolicy::Never() rather than flush every event on its own.
+	template <std::derived_from<LogOutput> InnerOutput>
+	class SynchronizedOutput final : public LogOutput
+	{
+	public:
+
+		/// Batch policy used when none is given
+		static constexpr LogForge::FlushPolicy DefaultBatchPolicy = {
+			.Characters = 16 * 1024,
+			.Interval = std::chrono::milliseconds(100),
+			.MinSeverity = Severity::Error
+		};
+
+		/// Constructor that uses twice as many shards as there are hardware threads, but at least 8, unless a shard count is given
+		explicit SynchronizedOutput(InnerOutput output, const LogForge::FlushPolicy batchPolicy = DefaultBatchPolicy, const std::size_t shardCount = 0) :
+			BatchPolicy(batchPolicy),
+			m_State(std::make_unique<State>(std::move(output), shardCount, batchPolicy.Interval))
+		{}
+
+		SynchronizedOutput(SynchronizedOutput&&) noexcept = default;
+		SynchronizedOutput(const SynchronizedOutput&) = delete;
+		SynchronizedOutput& operator = (const SynchronizedOutput&) = delete;
+		SynchronizedOutput& operator = (SynchronizedOutput&&) = delete;
+
+		~SynchronizedOutput() override
+		{
+			if (m_State != nullptr) Flush();
+		}
+
+		void Output(const OutputEvent& event) const override
+		{
+			auto& shard = m_State->GetShard();
+			std::lock_guard lock(shard.Mutex);
+
+			shard.Stage(event);
+
+			if (BatchPolicy.IsDue(event.Origin.Severity, shard.Characters, shard.LastFlush))
+			{
+				std::lock_guard outputLock(m_State->OutputMutex);
+				shard.WriteTo(m_State->Output);
+
+				// Shards that are busy are written by their own threads
+				for (std::size_t i = 0; i < m_State->ShardCount; ++i)
+				{
+					auto& other = m_State->Shards[i];
+					if (&other == &shard) continue;
+
+					if (std::unique_lock otherLock(other.Mutex, std::try_to_lock); otherLock.owns_lock() and other.Events > 0)
+					{
+						other.WriteTo(m_State->Output);
+					}
+				}
+
+				m_State->FlushOutput();
+			}
+		}
+
+		/// Writes all staged events to the inner output and flushes it if it has a Flush() function
+		void Flush() const
+		{
+			for (std::size_t i = 0; i < m_State->ShardCount; ++i)
+			{
+				auto& shard = m_State->Shards[i];
+				std::lock_guard lock(shard.Mutex);
+				std::lock_guard outputLock(m_State->OutputMutex);
+				shard.WriteTo(m_State->Output);
+			}
+
+			std::lock_guard outputLock(m_State->OutputMutex);
+			m_State->FlushOutput();
+		}
+
+		[[nodiscard]] std::size_t GetShardCount() const noexcept
+		{
+			return m_State->ShardCount;
+		}
+
+	private:
+
+		/// Events staged by the threads that use a shard
+		struct alignas(64) Shard
+		{
+			/// Event whose lines are stored in the LineBuffer of the shard
+			struct StagedEvent
+			{
+				std::size_t FirstLine = 0;
+				std::size_t LastLine = 0;
+				LogEvent Origin;
+			};
+
+			void Stage(const OutputEvent& event)
+			{
+				const auto firstLine = Lines.LineCount();
+				for (const auto& line : event.Lines)
+				{
+					Lines.AddLine(line);
+					Characters += line.size() + 1;
+				}
+
+				// Slots of earlier batches are reused, so their messages keep their memory
+				if (Events == Staged.size()) Staged.emplace_back();
+
+				auto& staged = Staged[Events++];
+				staged.FirstLine = firstLine;
+				staged.LastLine = Lines.LineCount();
+				AssignDetached(staged.Origin, event.Origin);
+			}
+
+			/// Writes the staged events. Both the shard and the output must be locked.
+			void WriteTo(const InnerOutput& output)
+			{
+				for (std::size_t i = 0; i < Events; ++i)
+				{
+					const auto& staged = Staged[i];
+					output.Output({ LineRange(Lines, staged.FirstLine, staged.LastLine), staged.Origin });
+				}
+
+				Lines.Clear();
+				Events = 0;
+				Characters = 0;
+				LastFlush = std::chrono::steady_clock::now();
+			}
+
+			std::mutex Mutex;
+			LineBuffer Lines;
+			std::vector<StagedEvent> Staged;
+			std::size_t Events = 0;
+			std::size_t Characters = 0;
+			std::chrono::steady_clock::time_point LastFlush = std::chrono::steady_clock::now();
+		};
+
+		/// The inner output, the shards and the helper thread. They live on the heap, so moving the output does not move them.
+		struct State
+		{
+			State(InnerOutput output, const std::size_t shardCount, const std::chrono::milliseconds interval) :
+				Output(std::move(output)),
+				ShardCount(std::bit_ceil(shardCount > 0 ? shardCount : std::max<std::size_t>(std::thread::hardware_concurrency() * 2, 8))),
+				Shards(std::make_unique<Shard[]>(ShardCount))
+			{
+				if (interval.count() > 0) Helper = std::thread([this, interval] { Run(interval); });
+			}
+
+			State(const State&) = delete;
+			State& operator = (const State&) = delete;
+
+			~State()
+			{
+				if (not Helper.joinable()) return;
+
+				{
+					std::lock_guard lock(HelperMutex);
+					Stopping = true;
+				}
+
+				HelperWakeup.notify_one();
+				Helper.join();
+			}
+
+			/// Flushes the inner output if it has a Flush() function. The output must be locked.
+			void FlushOutput() const
+			{
+				if constexpr (requires (const InnerOutput& output) { output.Flush(); })
+				{
+					Output.Flush();
+				}
+			}
+
+			/// Returns the shard of the calling thread. Threads are numbered in the order they first log, so they spread evenly.
+			[[nodiscard]] Shard& GetShard() const noexcept
+			{
+				static std::atomic<std::size_t> nextThread = 0;
+				thread_local const std::size_t threadNumber = nextThread.fetch_add(1, std::memory_order_relaxed);
+
+				return Shards[threadNumber & (ShardCount - 1)];
+			}
+
+			/// Writes the shards that were last written at least one interval ago, once per interval
+			void Run(const std::chrono::milliseconds interval)
+			{
+				std::unique_lock lock(HelperMutex);
+				while (not HelperWakeup.wait_for(lock, interval, [this] { return Stopping; }))
+				{
+					lock.unlock();
+					WriteExpired(interval);
+					lock.lock();
+				}
+			}
+
+			void WriteExpired(const std::chrono::milliseconds interval)
+			{
+				const auto now = std::chrono::steady_clock::now();
+				bool written = false;
+
+				for (std::size_t i = 0; i < ShardCount; ++i)
+				{
+					// A shard that is locked belongs to a thread that is logging, which checks the policy itself
+					auto& shard = Shards[i];
+					std::unique_lock shardLock(shard.Mutex, std::try_to_lock);
+					if (not shardLock.owns_lock() or shard.Events == 0 or now - shard.LastFlush < interval) continue;
+
+					std::lock_guard outputLock(OutputMutex);
+					shard.WriteTo(Output);
+					written = true;
+				}
+
+				if (written)
+				{
+					std::lock_guard outputLock(OutputMutex);
+					FlushOutput();
+				}
+			}
+
+			InnerOutput Output;
+			std::mutex OutputMutex;
+			const std::size_t ShardCount;
+			std::unique_ptr<Shard[]> Shards;
+
+			std::thread Helper;
+			std::mutex HelperMutex;
+			std::condition_variable HelperWakeup;
+			bool Stopping = false;
+		};
+
+	public:
+
+		const LogForge::FlushPolicy BatchPolicy;
+
+	private:
+
+		std::unique_ptr<State> m_State;
+
+	};
+
+}
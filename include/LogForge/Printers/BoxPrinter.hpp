@@ -1,9 +1,9 @@
 ﻿#pragma once
 
 #include <concepts>
-#include <ranges>
 
 #include "../LogPrinter.hpp"
+#include "../Utilities/Encoding.hpp"
 
 namespace LogForge
 {
@@ -13,50 +13,61 @@ namespace LogForge
 	{
 	public:
 
-		static constexpr auto TopLeft = L'┌';
-		static constexpr auto TopRight = L'┐';
-		static constexpr auto BottomLeft = L'└';
-		static constexpr auto BottomRight = L'┘';
-		static constexpr auto Horizontal = L'─';
-		static constexpr auto Vertical = L'│';
+		static constexpr auto TopLeft = LineView(LOGFORGE_TEXT("┌"));
+		static constexpr auto TopRight = LineView(LOGFORGE_TEXT("┐"));
+		static constexpr auto BottomLeft = LineView(LOGFORGE_TEXT("└"));
+		static constexpr auto BottomRight = LineView(LOGFORGE_TEXT("┘"));
+		static constexpr auto Horizontal = LineView(LOGFORGE_TEXT("─"));
+		static constexpr auto Vertical = LineView(LOGFORGE_TEXT("│"));
 
 		constexpr explicit BoxPrinter(Printer realPrinter) noexcept :
 			RealPrinter(std::move(realPrinter))
 		{
 		}
 
-		[[nodiscard]] Lines Print(const LogEvent& event) const override
+		void Print(const LogEvent& event, LineBuffer& output) const override
 		{
-			auto printedLines = RealPrinter.Print(event);
-			const auto longestLine = GetLongestLineLength(printedLines);
-			if (not longestLine.has_value()) return printedLines;;
+			const auto firstLine = output.LineCount();
+			RealPrinter.Print(event, output);
+			if (firstLine == output.LineCount()) return;
 
-			const auto horizontalLine = Line(longestLine.value(), Horizontal);
-			const auto upperLine = TopLeft + horizontalLine + TopRight;
-			const auto lowerLine = BottomLeft + horizontalLine + BottomRight;
-
-			const auto boxedLines = printedLines | std::ranges::views::transform([longestLine](const Line& line)
+			const auto longestLine = output.GetLongestLineWidth(firstLine);
+			for (auto line = firstLine; line < output.LineCount(); ++line)
 			{
-				const auto spacingCount = longestLine.value() - line.length();
-				const auto trailingSpacing = Line(spacingCount, L' ');
-
-				return Vertical + line + trailingSpacing + Vertical;
-			});
-
-			Lines output;
-			output.reserve(printedLines.size() + 2);
-			output.insert(output.end(), upperLine);
-			output.insert(output.end(), boxedLines.begin(), boxedLines.end());
-			output.insert(output.end(), lowerLine);
+				output.Append(line, longestLine - GetDisplayWidth(output[line]), LOGFORGE_TEXT(' '));
+				output.Append(line, Vertical);
+				output.Prepend(line, Vertical);
+			}
+
+			const auto upperLine = output.InsertLine(firstLine, TopLeft);
+			AppendHorizontalLine(output, upperLine, longestLine);
+			output.Append(upperLine, TopRight);
+
+			const auto lowerLine = output.AddLine(BottomLeft);
+			AppendHorizontalLine(output, lowerLine, longestLine);
+			output.Append(lowerLine, BottomRight);
+		}
 
-			return output;
+		[[nodiscard]] LineReserve GetLineReserve() const noexcept override
+		{
+			return RealPrinter.GetLineReserve() + LineReserve { .Head = Vertical.length(), .Tail = Vertical.length() };
 		}
 
 	private:
 
-		[[nodiscard]] static std::optional<std::size_t> GetLongestLineLength(const Lines& lines)
+		static void AppendHorizontalLine(LineBuffer& output, const std::size_t line, const std::size_t width)
 		{
-			return std::ranges::max(lines | std::ranges::views::transform([](const Line& line) { return line.length(); }));
+			if constexpr (sizeof(Char) == 1)
+			{
+				for (std::size_t i = 0; i < width; ++i)
+				{
+					output.Append(line, Horizontal);
+				}
+			}
+			else
+			{
+				output.Append(line, width, Horizontal.front());
+			}
 		}
 
 	public:
@@ -1,8 +1,9 @@
 #pragma once
 
+#include <algorithm>
 #include <concepts>
-#include <unordered_map>
 #include <ranges>
+#include <unordered_map>
 
 #include "../LogPrinter.hpp"
 
@@ -12,12 +13,12 @@ namespace LogForge
 	typedef std::unordered_map<Severity, std::optional<Line>> SeverityColors;
 
 	inline static const SeverityColors DefaultSeverityColors = {
-		{ Severity::Trace, L"\x1B[38;5;244m" },
+		{ Severity::Trace, LOGFORGE_TEXT("\x1B[38;5;244m") },
 		{ Severity::Debug, std::nullopt },
-		{ Severity::Info, L"\x1B[38;5;12m" },
-		{ Severity::Warning, L"\x1B[38;5;208m" },
-		{ Severity::Error, L"\x1B[38;5;196m" },
-		{ Severity::Fatal, L"\x1B[38;5;199m" }
+		{ Severity::Info, LOGFORGE_TEXT("\x1B[38;5;12m") },
+		{ Severity::Warning, LOGFORGE_TEXT("\x1B[38;5;208m") },
+		{ Severity::Error, LOGFORGE_TEXT("\x1B[38;5;196m") },
+		{ Severity::Fatal, LOGFORGE_TEXT("\x1B[38;5;199m") }
 	};
 
 	template <std::derived_from<LogPrinter> Printer>
@@ -25,51 +26,69 @@ namespace LogForge
 	{
 	public:
 
+		static constexpr auto ResetColor = LineView(LOGFORGE_TEXT("\x1B[0m"));
+
 		explicit ColoredPrinter(
 			Printer realPrinter,
-			SeverityColors severityColors = DefaultSeverityColors
+			LogForge::SeverityColors severityColors = DefaultSeverityColors
 		) noexcept :
 			RealPrinter(std::move(realPrinter)),
-			SeverityColors(std::move(severityColors))
+			SeverityColors(std::move(severityColors)),
+			LongestColorLength(GetLongestColorLength(SeverityColors))
 		{}
 
-		[[nodiscard]] Lines Print(const LogEvent& event) const override
+		void Print(const LogEvent& event, LineBuffer& output) const override
 		{
-			auto printedLines = RealPrinter.Print(event);
+			const auto firstLine = output.LineCount();
+			RealPrinter.Print(event, output);
+
 			const auto color = GetColorForSeverity(event.Severity);
-			if (not color.has_value()) return printedLines;
+			if (color == nullptr) return;
 
-			const auto coloredLines = printedLines | std::ranges::views::transform([colorCode = color.value()](const Line& line)
+			for (auto line = firstLine; line < output.LineCount(); ++line)
 			{
-				return Colorize(line, colorCode);
-			});
+				output.Prepend(line, *color);
+				output.Append(line, ResetColor);
+			}
+		}
 
-			return { coloredLines.begin(), coloredLines.end() };
+		[[nodiscard]] LineReserve GetLineReserve() const noexcept override
+		{
+			return RealPrinter.GetLineReserve() + LineReserve { .Head = LongestColorLength, .Tail = ResetColor.length() };
 		}
 
 	private:
 
-		[[nodiscard]] std::optional<Line> GetColorForSeverity(const Severity severity) const
+		[[nodiscard]] const Line* GetColorForSeverity(const Severity severity) const
 		{
 			const auto color = SeverityColors.find(severity);
-			if (color != SeverityColors.end())
+			if (color != SeverityColors.end() and color->second.has_value())
 			{
-				return color->second;
+				return &color->second.value();
 			}
 
-			return std::nullopt;
+			return nullptr;
 		}
 
-		[[nodiscard]] static Line Colorize(const Line& line, const Line& color)
+		[[nodiscard]] static std::size_t GetLongestColorLength(const LogForge::SeverityColors& severityColors)
 		{
-			static constexpr auto resetColor = L"\x1B[0m";
-			return color + line + resetColor;
+			std::size_t longest = 0;
+			for (const auto& color : severityColors | std::ranges::views::values)
+			{
+				if (color.has_value())
+				{
+					longest = std::max(longest, color->length());
+				}
+			}
+
+			return longest;
 		}
 
 	public:
 
 		Printer RealPrinter;
-		SeverityColors SeverityColors;
+		LogForge::SeverityColors SeverityColors;
+		std::size_t LongestColorLength;
 
 	};
 
@@ -77,7 +96,7 @@ namespace LogForge
 	{
 	public:
 
-		explicit ColoredPrinterBuilder(SeverityColors severityColors = DefaultSeverityColors) noexcept :
+		explicit ColoredPrinterBuilder(LogForge::SeverityColors severityColors = DefaultSeverityColors) noexcept :
 			SeverityColors(std::move(severityColors))
 		{}
 
@@ -88,7 +107,7 @@ namespace LogForge
 
 	public:
 
-		SeverityColors SeverityColors;
+		LogForge::SeverityColors SeverityColors;
 
 	};
 
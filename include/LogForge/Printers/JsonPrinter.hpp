@@ -0,0 +1,241 @@
+#pragma once
+
+#include "../Severity.hpp"
+#include "../LogPrinter.hpp"
+#include "PrefixPrinter.hpp"
+#include "../Utilities/CallSiteMap.hpp"
+#include "../Utilities/CharacterScan.hpp"
+#include "../Utilities/Encoding.hpp"
+#include "../Time/TimeFormatter.hpp"
+
+#include <cmath>
+#include <memory>
+#include <string>
+
+namespace LogForge
+{
+
+	/// Printer that renders the whole event as one line of JSON, for JSON Lines pipelines.
+	///
+	/// Every event becomes an object with the time, the level, the message (or
+	/// `error` for exceptions), the structured fields as a nested `fields` object
+	/// and the source location as a nested `source` object:
+	///
+	///     {"time":"2024-05-01T12:00:00.123456789+02:00","level":"info","message":"Started","source":{"file":"main.cpp","line":12,"column":9,"function":"int main()"}}
+	///
+	/// Strings are escaped by scanning for quotes, backslashes and control
+	/// characters with AppendEscapedRuns, which copies the runs in between in one go.
+	/// The escaped source location is cached per call site like LocationPrinter
+	/// does; copies of the printer share the cache.
+	class JsonPrinter final : public LogPrinter
+	{
+	public:
+
+		inline static const LogForge::SeverityPrefixes DefaultSeverityNames = {
+			{ Severity::Trace, LOGFORGE_TEXT("trace") },
+			{ Severity::Debug, LOGFORGE_TEXT("debug") },
+			{ Severity::Info, LOGFORGE_TEXT("info") },
+			{ Severity::Warning, LOGFORGE_TEXT("warning") },
+			{ Severity::Error, LOGFORGE_TEXT("error") },
+			{ Severity::Fatal, LOGFORGE_TEXT("fatal") }
+		};
+
+		/// RFC 3339 in local time with nanoseconds
+		inline static const Line DefaultTimeFormat = LOGFORGE_TEXT("%FT%T.%9N%:z");
+
+		explicit JsonPrinter(
+			LogForge::SeverityPrefixes severityNames = DefaultSeverityNames,
+			Line timeFormat = DefaultTimeFormat
+		) :
+			SeverityNames(std::move(severityNames)),
+			TimeFormat(std::move(timeFormat)),
+			m_Cache(std::make_shared<CallSiteMap<Line>>())
+		{}
+
+		void Print(const LogEvent& event, LineBuffer& output) const override
+		{
+			const auto line = output.AddLine(LOGFORGE_TEXT("{"));
+
+			if (const auto time = TimeFormat.Format(event.Time))
+			{
+				AppendKey(output, line, LOGFORGE_TEXT("time"));
+				AppendString(output, line, time.value());
+			}
+
+			const auto name = SeverityNames.find(event.Severity);
+			if (name != SeverityNames.end() and name->second.has_value())
+			{
+				AppendKey(output, line, LOGFORGE_TEXT("level"));
+				AppendString(output, line, name->second.value());
+			}
+
+			AppendMessage(output, line, event.Message);
+
+			if (not event.Fields.IsEmpty())
+			{
+				AppendFields(output, line, event.Fields);
+			}
+
+			AppendKey(output, line, LOGFORGE_TEXT("source"));
+			output.Append(line, FormatLocation(event.SourceLocation));
+			output.Append(line, 1, LOGFORGE_TEXT('}'));
+		}
+
+	private:
+
+		static void AppendMessage(LineBuffer& output, const std::size_t line, const LogMessage& message)
+		{
+			std::visit([&output, line]<typename T>(const T& msg)
+			{
+				if constexpr (std::is_same_v<std::decay_t<T>, Line>)
+				{
+					AppendKey(output, line, LOGFORGE_TEXT("message"));
+					AppendString(output, line, msg);
+				}
+				else if constexpr (std::is_same_v<std::decay_t<T>, DeferredMessage>)
+				{
+					thread_local Line formatted;
+					formatted.clear();
+					msg.FormatTo(formatted);
+					AppendKey(output, line, LOGFORGE_TEXT("message"));
+					AppendString(output, line, formatted);
+				}
+				else if constexpr (std::is_same_v<std::decay_t<T>, LazyMessage>)
+				{
+					AppendKey(output, line, LOGFORGE_TEXT("message"));
+					AppendString(output, line, msg.Resolve());
+				}
+				else if constexpr (std::is_same_v<std::decay_t<T>, std::exception>)
+				{
+					thread_local Line formatted;
+					formatted.clear();
+					AppendNarrow(formatted, msg.what());
+					AppendKey(output, line, LOGFORGE_TEXT("error"));
+					AppendString(output, line, formatted);
+				}
+			}, message);
+		}
+
+		static void AppendFields(LineBuffer& output, const std::size_t line, const LogFields& fields)
+		{
+			AppendKey(output, line, LOGFORGE_TEXT("fields"));
+			output.Append(line, 1, LOGFORGE_TEXT('{'));
+
+			for (const auto& field : fields)
+			{
+				AppendKey(output, line, field.Key);
+
+				if (field.Type == FieldType::String)
+				{
+					AppendString(output, line, field.Text);
+				}
+				else if (field.Type == FieldType::Float and not std::isfinite(field.Float))
+				{
+					// JSON has no literals for infinity and NaN
+					output.Append(line, LOGFORGE_TEXT("null"));
+				}
+				else
+				{
+					thread_local Line value;
+					value.clear();
+					field.AppendValue(value);
+					output.Append(line, value);
+				}
+			}
+
+			output.Append(line, 1, LOGFORGE_TEXT('}'));
+		}
+
+		/// Appends the quoted key and a colon, separated by a comma from the previous member
+		static void AppendKey(LineBuffer& output, const std::size_t line, const LineView key)
+		{
+			const auto text = output[line];
+			if (text.back() != LOGFORGE_TEXT('{')) output.Append(line, 1, LOGFORGE_TEXT(','));
+
+			AppendString(output, line, key);
+			output.Append(line, 1, LOGFORGE_TEXT(':'));
+		}
+
+		/// Appends the value as a JSON string, copying the runs between characters that need escaping in one go
+		static void AppendString(LineBuffer& output, const std::size_t line, const LineView value)
+		{
+			static constexpr CharacterSet NeedsEscaping = { .Below = LOGFORGE_TEXT(' '), .First = LOGFORGE_TEXT('"'), .Second = LOGFORGE_TEXT('\\') };
+
+			output.Append(line, 1, LOGFORGE_TEXT('"'));
+			AppendEscapedRuns(output, line, value, NeedsEscaping, AppendEscaped);
+			output.Append(line, 1, LOGFORGE_TEXT('"'));
+		}
+
+		static void AppendEscaped(LineBuffer& output, const std::size_t line, const Char character)
+		{
+			switch (character)
+			{
+				case LOGFORGE_TEXT('"'):	output.Append(line, LOGFORGE_TEXT("\\\"")); return;
+				case LOGFORGE_TEXT('\\'):	output.Append(line, LOGFORGE_TEXT("\\\\")); return;
+				case LOGFORGE_TEXT('\b'):	output.Append(line, LOGFORGE_TEXT("\\b")); return;
+				case LOGFORGE_TEXT('\f'):	output.Append(line, LOGFORGE_TEXT("\\f")); return;
+				case LOGFORGE_TEXT('\n'):	output.Append(line, LOGFORGE_TEXT("\\n")); return;
+				case LOGFORGE_TEXT('\r'):	output.Append(line, LOGFORGE_TEXT("\\r")); return;
+				case LOGFORGE_TEXT('\t'):	output.Append(line, LOGFORGE_TEXT("\\t")); return;
+				default:			AppendUnicodeEscape(output, line, character); return;
+			}
+		}
+
+		/// Returns the escaped source object of the call site
+		[[nodiscard]] LineView FormatLocation(const SourceLocation& location) const
+		{
+			const auto* cached = m_Cache->GetOrInsert(location, [&location] { return GenerateLocation(location); });
+			if (cached != nullptr) return *cached;
+
+			// The cache is full, so this call site is formatted every time
+			thread_local Line formatted;
+			formatted = GenerateLocation(location);
+			return formatted;
+		}
+
+		[[nodiscard]] static Line GenerateLocation(const SourceLocation& location)
+		{
+			LineBuffer buffer;
+			const auto line = buffer.AddLine(LOGFORGE_TEXT("{"));
+
+			Line text;
+			AppendNarrow(text, location.file_name());
+			AppendKey(buffer, line, LOGFORGE_TEXT("file"));
+			AppendString(buffer, line, text);
+
+			text.clear();
+			AppendNarrow(text, std::to_string(location.line()));
+			AppendKey(buffer, line, LOGFORGE_TEXT("line"));
+			buffer.Append(line, text);
+
+			text.clear();
+			AppendNarrow(text, std::to_string(location.column()));
+			AppendKey(buffer, line, LOGFORGE_TEXT("column"));
+			buffer.Append(line, text);
+
+			text.clear();
+			AppendNarrow(text, location.function_name());
+			AppendKey(buffer, line, LOGFORGE_TEXT("function"));
+			AppendString(buffer, line, text);
+
+			buffer.Append(line, 1, LOGFORGE_TEXT('}'));
+			return Line(buffer[line]);
+		}
+
+	public:
+
+		LogForge::SeverityPrefixes SeverityNames;
+		TimeFormatter TimeFormat;
+
+	private:
+
+		std::shared_ptr<CallSiteMap<Line>> m_Cache;
+
+	};
+
+	[[nodiscard]] inline auto Json(SeverityPrefixes severityNames = JsonPrinter::DefaultSeverityNames, Line timeFormat = JsonPrinter::DefaultTimeFormat) -> decltype(JsonPrinter { std::move(severityNames), std::move(timeFormat) })
+	{
+		return JsonPrinter { std::move(severityNames), std::move(timeFormat) };
+	}
+
+}
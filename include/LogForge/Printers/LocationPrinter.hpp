@@ -1,24 +1,40 @@
 #pragma once
 
 #include <functional>
+#include <memory>
 #include <sstream>
 
 #include "../LogPrinter.hpp"
+#include "../Utilities/CallSiteMap.hpp"
+#include "../Utilities/Encoding.hpp"
 
 namespace LogForge
 {
 
 	typedef std::function<Line(SourceLocation)> SourceLocationFormatter;
 
-	inline static constexpr auto DefaultLocationPrefix = L"Location: ";
+	inline static constexpr auto DefaultLocationPrefix = LOGFORGE_TEXT("Location: ");
 
 	inline Line DefaultSourceLocationFormatter(const SourceLocation& location)
 	{
-		std::wstringstream stream;
-		stream << location.file_name() << L"(" << location.line() << L", " << location.column() << "): " << location.function_name();
-		return stream.str();
+		// File and function names are UTF-8, which a wide stream would widen byte by byte
+		Line formatted;
+		AppendNarrow(formatted, location.file_name());
+
+		std::basic_ostringstream<Char> stream;
+		stream << LOGFORGE_TEXT("(") << location.line() << LOGFORGE_TEXT(", ") << location.column() << LOGFORGE_TEXT("): ");
+		formatted += stream.view();
+
+		AppendNarrow(formatted, location.function_name());
+		return formatted;
 	}
 
+	/// Printer that adds the source location of the event in front of its lines.
+	///
+	/// The formatted location is cached per call site, so the formatter only runs
+	/// for the first event of every call site. Copies of the printer share the
+	/// cache. Changing SourceLocationFormatter afterwards does not affect call
+	/// sites that are already cached.
 	template <std::derived_from<LogPrinter> Printer>
 	class LocationPrinter final : public LogPrinter
 	{
@@ -26,41 +42,54 @@ namespace LogForge
 
 		explicit LocationPrinter(
 			Printer realPrinter,
-			SourceLocationFormatter sourceLocationFormatter = &DefaultSourceLocationFormatter,
+			LogForge::SourceLocationFormatter sourceLocationFormatter = &DefaultSourceLocationFormatter,
 			Line prefix = DefaultLocationPrefix
-		) noexcept :
+		) :
 			RealPrinter(std::move(realPrinter)),
 			SourceLocationFormatter(std::move(sourceLocationFormatter)),
-			Prefix(std::move(prefix))
+			Prefix(std::move(prefix)),
+			m_Cache(std::make_shared<CallSiteMap<Line>>())
 		{}
 
-		[[nodiscard]] Lines Print(const LogEvent& event) const override
+		void Print(const LogEvent& event, LineBuffer& output) const override
 		{
-			auto printedLines = RealPrinter.Print(event);
-			const auto locationLine = FormatLocation(event.SourceLocation).value_or(L"<Invalid Location>");
-			const auto prefixedLocationLine = Prefix + locationLine;
-
-			Lines output;
-			output.reserve(printedLines.size() + 1);
-			output.insert(output.begin(), prefixedLocationLine);
-			output.insert(output.end(), printedLines.begin(), printedLines.end());
-			return output;
+			const auto firstLine = output.LineCount();
+			RealPrinter.Print(event, output);
+
+			const auto locationLine = output.InsertLine(firstLine, Prefix);
+			output.Append(locationLine, FormatLocation(event.SourceLocation).value_or(LOGFORGE_TEXT("<Invalid Location>")));
+		}
+
+		[[nodiscard]] LineReserve GetLineReserve() const noexcept override
+		{
+			return RealPrinter.GetLineReserve();
 		}
 
 	private:
 
-		[[nodiscard]] std::optional<Line> FormatLocation(const SourceLocation& location) const
+		[[nodiscard]] std::optional<LineView> FormatLocation(const SourceLocation& location) const
 		{
 			if (SourceLocationFormatter == nullptr) return std::nullopt;
-			return SourceLocationFormatter(location);
+
+			const auto* cached = m_Cache->GetOrInsert(location, [this, &location] { return SourceLocationFormatter(location); });
+			if (cached != nullptr) return LineView(*cached);
+
+			// The cache is full, so this call site is formatted every time
+			thread_local Line formatted;
+			formatted = SourceLocationFormatter(location);
+			return LineView(formatted);
 		}
 
 	public:
 
 		Printer RealPrinter;
-		SourceLocationFormatter SourceLocationFormatter;
+		LogForge::SourceLocationFormatter SourceLocationFormatter;
 		Line Prefix;
 
+	private:
+
+		std::shared_ptr<CallSiteMap<Line>> m_Cache;
+
 	};
 
 	class LocationPrinterBuilder
@@ -68,7 +97,7 @@ namespace LogForge
 	public:
 
 		explicit LocationPrinterBuilder(
-			SourceLocationFormatter sourceLocationFormatter = &DefaultSourceLocationFormatter,
+			LogForge::SourceLocationFormatter sourceLocationFormatter = &DefaultSourceLocationFormatter,
 			Line prefix = DefaultLocationPrefix
 		) noexcept :
 			SourceLocationFormatter(std::move(sourceLocationFormatter)),
@@ -82,7 +111,7 @@ namespace LogForge
 
 	public:
 
-		SourceLocationFormatter SourceLocationFormatter;
+		LogForge::SourceLocationFormatter SourceLocationFormatter;
 		Line Prefix;
 
 	};
@@ -3,123 +3,163 @@
 #include "../Severity.hpp"
 #include "../LogPrinter.hpp"
 #include "PrefixPrinter.hpp"
+#include "../Utilities/CharacterScan.hpp"
+#include "../Utilities/Encoding.hpp"
+#include "../Time/TimeFormatter.hpp"
 
 namespace LogForge
 {
 
+	/// Printer that renders the whole event as one line of logfmt key=value pairs.
+	///
+	/// Everything is appended straight into the line buffer in a single pass.
+	/// Values that contain spaces, control characters, `=` or `"` are quoted, and
+	/// within quotes `"`, `\` and control characters are escaped; all other values
+	/// are copied as they are. Keys of fields are written without quoting.
 	class LogFmtPrinter final : public LogPrinter
 	{
 	public:
 
-		inline static const SeverityPrefixes DefaultSeverityPrefixes = {
-			{ Severity::Trace, L"trace" },
-			{ Severity::Debug, L"debug" },
-			{ Severity::Info, L"info" },
-			{ Severity::Warning, L"warning" },
-			{ Severity::Error, L"error" },
-			{ Severity::Fatal, L"fatal" }
+		inline static const LogForge::SeverityPrefixes DefaultSeverityPrefixes = {
+			{ Severity::Trace, LOGFORGE_TEXT("trace") },
+			{ Severity::Debug, LOGFORGE_TEXT("debug") },
+			{ Severity::Info, LOGFORGE_TEXT("info") },
+			{ Severity::Warning, LOGFORGE_TEXT("warning") },
+			{ Severity::Error, LOGFORGE_TEXT("error") },
+			{ Severity::Fatal, LOGFORGE_TEXT("fatal") }
 		};
 
-		inline static const Line DefaultTimeFormat = L"%FT%T%z";
+		inline static const Line DefaultTimeFormat = LOGFORGE_TEXT("%FT%T%z");
 
 		explicit LogFmtPrinter(
-			SeverityPrefixes severityPrefixes = DefaultSeverityPrefixes,
+			LogForge::SeverityPrefixes severityPrefixes = DefaultSeverityPrefixes,
 			Line timeFormat = DefaultTimeFormat
-		) noexcept :
+		) :
 			SeverityPrefixes(std::move(severityPrefixes)),
 			TimeFormat(std::move(timeFormat))
 		{}
 
-		[[nodiscard]] Lines Print(const LogEvent& event) const override
+		void Print(const LogEvent& event, LineBuffer& output) const override
 		{
-			Lines lines;
+			const auto line = output.AddLine();
 
-			if (const auto prefix = GenerateLevel(event.Severity))
+			const auto prefix = SeverityPrefixes.find(event.Severity);
+			if (prefix != SeverityPrefixes.end() and prefix->second.has_value())
 			{
-				lines.emplace_back(prefix.value());
+				AppendPair(output, line, LOGFORGE_TEXT("level"), prefix->second.value());
 			}
 
-			if (const auto message = GenerateMessage(event.Message))
-			{
-				lines.emplace_back(message.value());
-			}
+			AppendMessage(output, line, event.Message);
 
-			if (const auto time = GenerateTime(event.Time))
+			for (const auto& field : event.Fields)
 			{
-				lines.emplace_back(time.value());
+				if (field.Type == FieldType::String)
+				{
+					AppendPair(output, line, field.Key, field.Text);
+					continue;
+				}
+
+				// Numbers and booleans never need quotes
+				thread_local Line value;
+				value.clear();
+				field.AppendValue(value);
+
+				AppendKey(output, line, field.Key);
+				output.Append(line, value);
 			}
 
-			Line line;
-			for (std::size_t i = 0; i < lines.size(); ++i)
+			if (const auto time = TimeFormat.Format(event.Time))
 			{
-				if (i > 0) line += L' ';
-				line += lines[i];
+				AppendPair(output, line, LOGFORGE_TEXT("time"), time.value());
 			}
-
-			return { line };
 		}
 
 	private:
 
-		[[nodiscard]] std::optional<Line> GenerateLevel(const Severity severity) const
+		static void AppendMessage(LineBuffer& output, const std::size_t line, const LogMessage& message)
 		{
-			using namespace std::string_literals;
-			const auto prefix = SeverityPrefixes.find(severity);
-			if (prefix != SeverityPrefixes.end() and prefix->second.has_value())
-			{
-				return L"level="s + prefix->second.value();
-			}
-
-			return std::nullopt;
-		}
-
-		[[nodiscard]] static std::optional<Line> GenerateMessage(const LogMessage& message)
-		{
-			using namespace std::string_literals;
-			return std::visit([]<typename T>(const T& msg) -> std::optional<Line>
+			std::visit([&output, line]<typename T>(const T& msg)
 			{
 				if constexpr (std::is_same_v<std::decay_t<T>, Line>)
 				{
-					return L"message="s + msg;
+					AppendPair(output, line, LOGFORGE_TEXT("message"), msg);
 				}
-				else if constexpr (std::is_same_v<std::decay_t<T>, std::exception>)
+				else if constexpr (std::is_same_v<std::decay_t<T>, DeferredMessage>)
 				{
-					std::wostringstream wss;
-					wss << L"error=" << msg.what();
-					return wss.str();
+					thread_local Line formatted;
+					formatted.clear();
+					msg.FormatTo(formatted);
+					AppendPair(output, line, LOGFORGE_TEXT("message"), formatted);
 				}
-				else
+				else if constexpr (std::is_same_v<std::decay_t<T>, LazyMessage>)
 				{
-					return {};
+					AppendPair(output, line, LOGFORGE_TEXT("message"), msg.Resolve());
+				}
+				else if constexpr (std::is_same_v<std::decay_t<T>, std::exception>)
+				{
+					thread_local Line formatted;
+					formatted.clear();
+					AppendNarrow(formatted, msg.what());
+					AppendPair(output, line, LOGFORGE_TEXT("error"), formatted);
 				}
 			}, message);
 		}
 
-		[[nodiscard]] std::optional<Line> GenerateTime(const TimePoint& time) const
+		/// Appends the key and the equals sign, separated by a space from the previous pair
+		static void AppendKey(LineBuffer& output, const std::size_t line, const LineView key)
+		{
+			if (not output[line].empty()) output.Append(line, 1, LOGFORGE_TEXT(' '));
+			output.Append(line, key);
+			output.Append(line, 1, LOGFORGE_TEXT('='));
+		}
+
+		static void AppendPair(LineBuffer& output, const std::size_t line, const LineView key, const LineView value)
 		{
-			using namespace std::string_literals;
-			const auto timePoint = Clock::to_time_t(time);
-			tm timeInfo = {};
-			if (localtime_s(&timeInfo, &timePoint) != 0)
+			AppendKey(output, line, key);
+
+			static constexpr CharacterSet NeedsQuotes = { .Below = LOGFORGE_TEXT('!'), .First = LOGFORGE_TEXT('='), .Second = LOGFORGE_TEXT('"') };
+			if (not value.empty() and FindFirstOf(value, NeedsQuotes) == value.size())
 			{
-				return std::nullopt;
+				output.Append(line, value);
+				return;
 			}
 
-			std::wostringstream wss;
-			wss << L"time=" << std::put_time(&timeInfo, TimeFormat.data());
-			return wss.str();
+			AppendQuoted(output, line, value);
+		}
+
+		/// Appends the value in quotes, copying the runs between characters that need escaping in one go
+		static void AppendQuoted(LineBuffer& output, const std::size_t line, const LineView value)
+		{
+			static constexpr CharacterSet NeedsEscaping = { .Below = LOGFORGE_TEXT(' '), .First = LOGFORGE_TEXT('"'), .Second = LOGFORGE_TEXT('\\') };
+
+			output.Append(line, 1, LOGFORGE_TEXT('"'));
+			AppendEscapedRuns(output, line, value, NeedsEscaping, AppendEscaped);
+			output.Append(line, 1, LOGFORGE_TEXT('"'));
+		}
+
+		static void AppendEscaped(LineBuffer& output, const std::size_t line, const Char character)
+		{
+			switch (character)
+			{
+				case LOGFORGE_TEXT('"'):	output.Append(line, LOGFORGE_TEXT("\\\"")); return;
+				case LOGFORGE_TEXT('\\'):	output.Append(line, LOGFORGE_TEXT("\\\\")); return;
+				case LOGFORGE_TEXT('\n'):	output.Append(line, LOGFORGE_TEXT("\\n")); return;
+				case LOGFORGE_TEXT('\r'):	output.Append(line, LOGFORGE_TEXT("\\r")); return;
+				case LOGFORGE_TEXT('\t'):	output.Append(line, LOGFORGE_TEXT("\\t")); return;
+				default:			AppendUnicodeEscape(output, line, character); return;
+			}
 		}
 
 	public:
 
-		SeverityPrefixes SeverityPrefixes;
-		Line TimeFormat;
+		LogForge::SeverityPrefixes SeverityPrefixes;
+		TimeFormatter TimeFormat;
 
 	};
 
-	[[nodiscard]] auto LogFmt(SeverityPrefixes severityPrefixes = LogFmtPrinter::DefaultSeverityPrefixes) noexcept -> decltype(LogFmtPrinter{ std::move(severityPrefixes) })
+	[[nodiscard]] inline auto LogFmt(SeverityPrefixes severityPrefixes = LogFmtPrinter::DefaultSeverityPrefixes, Line timeFormat = LogFmtPrinter::DefaultTimeFormat) -> decltype(LogFmtPrinter { std::move(severityPrefixes), std::move(timeFormat) })
 	{
-		return LogFmtPrinter { std::move(severityPrefixes) };
+		return LogFmtPrinter { std::move(severityPrefixes), std::move(timeFormat) };
 	}
 
-}
\ No newline at end of file
+}
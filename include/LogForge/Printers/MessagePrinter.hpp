@@ -1,9 +1,7 @@
 #pragma once
 
-#include <ranges>
-#include <sstream>
-
 #include "../LogPrinter.hpp"
+#include "../Utilities/Encoding.hpp"
 
 namespace LogForge
 {
@@ -14,30 +12,70 @@ namespace LogForge
 
 		constexpr MessagePrinter() noexcept = default;
 
-		[[nodiscard]] Lines Print(const LogEvent& event) const override
+		void Print(const LogEvent& event, LineBuffer& output) const override
 		{
-			return std::visit([]<typename T>(const T& message) -> Lines
+			std::visit([&output]<typename T>(const T& message)
 			{
 				if constexpr (std::is_same_v<std::remove_cvref_t<T>, Line>)
 				{
-					auto lines = message | std::ranges::views::split(L'\n') | std::ranges::views::transform([](const auto& subrange)
-					{
-						return Line { subrange.begin(), subrange.end() };
-					});
-
-					return Lines { lines.begin(), lines.end() };
+					AddLines(output, message);
 				}
-				else if constexpr (std::is_same_v<std::remove_cvref_t<T>, std::exception>)
+				else if constexpr (std::is_same_v<std::remove_cvref_t<T>, DeferredMessage>)
+				{
+					thread_local Line formatted;
+					formatted.clear();
+					message.FormatTo(formatted);
+					AddLines(output, formatted);
+				}
+				else if constexpr (std::is_same_v<std::remove_cvref_t<T>, LazyMessage>)
 				{
-					std::wostringstream wss;
-					wss << L"Error: " << message.what();
-					return { wss.str() };
+					AddLines(output, message.Resolve());
 				}
-				else
+				else if constexpr (std::is_same_v<std::remove_cvref_t<T>, std::exception>)
 				{
-					return {};
+					thread_local Line formatted;
+					formatted = LOGFORGE_TEXT("Error: ");
+					AppendNarrow(formatted, message.what());
+					output.AddLine(formatted);
 				}
 			}, event.Message);
+
+			if (not event.Fields.IsEmpty())
+			{
+				AppendFields(output, event.Fields);
+			}
+		}
+
+	private:
+
+		/// Appends the fields as key=value pairs to the last line of the message
+		static void AppendFields(LineBuffer& output, const LogFields& fields)
+		{
+			thread_local Line formatted;
+			formatted.clear();
+
+			for (const auto& field : fields)
+			{
+				formatted += LOGFORGE_TEXT(' ');
+				formatted += field.Key;
+				formatted += LOGFORGE_TEXT('=');
+				field.AppendValue(formatted);
+			}
+
+			output.Append(output.LineCount() - 1, formatted);
+		}
+
+		/// Adds one line per line break separated part of the message
+		static void AddLines(LineBuffer& output, const LineView message)
+		{
+			std::size_t begin = 0;
+			for (auto end = message.find(LOGFORGE_TEXT('\n')); end != LineView::npos; end = message.find(LOGFORGE_TEXT('\n'), begin))
+			{
+				output.AddLine(message.substr(begin, end - begin));
+				begin = end + 1;
+			}
+
+			output.AddLine(message.substr(begin));
 		}
 
 	};
@@ -46,4 +84,4 @@ namespace LogForge
 	{
 		return MessagePrinter {};
 	}
-}
\ No newline at end of file
+}
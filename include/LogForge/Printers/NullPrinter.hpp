@@ -0,0 +1,25 @@
+#pragma once
+
+#include "../LogPrinter.hpp"
+
+namespace LogForge
+{
+
+	/// Printer that renders nothing, for outputs such as BinaryOutput that only read the event itself
+	class NullPrinter final : public LogPrinter
+	{
+	public:
+
+		constexpr NullPrinter() noexcept = default;
+
+		void Print(const LogEvent&, LineBuffer&) const override
+		{
+		}
+
+	};
+
+	[[nodiscard]] constexpr auto Nothing() noexcept -> decltype(NullPrinter {})
+	{
+		return NullPrinter {};
+	}
+}
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <algorithm>
 #include <ranges>
 #include <unordered_map>
 
@@ -11,12 +12,12 @@ namespace LogForge
 	typedef std::unordered_map<Severity, std::optional<Line>> SeverityPrefixes;
 
 	inline static const SeverityPrefixes DefaultSeverityPrefixes = {
-		{ Severity::Trace, L"[TRACE]: " },
-		{ Severity::Debug, L"[DEBUG]: " },
-		{ Severity::Info, L"[INFO]: " },
-		{ Severity::Warning, L"[WARNING]: " },
-		{ Severity::Error, L"[ERROR]: " },
-		{ Severity::Fatal, L"[FATAL]: " }
+		{ Severity::Trace, LOGFORGE_TEXT("[TRACE]: ") },
+		{ Severity::Debug, LOGFORGE_TEXT("[DEBUG]: ") },
+		{ Severity::Info, LOGFORGE_TEXT("[INFO]: ") },
+		{ Severity::Warning, LOGFORGE_TEXT("[WARNING]: ") },
+		{ Severity::Error, LOGFORGE_TEXT("[ERROR]: ") },
+		{ Severity::Fatal, LOGFORGE_TEXT("[FATAL]: ") }
 	};
 
 	template <std::derived_from<LogPrinter> Printer>
@@ -24,38 +25,44 @@ namespace LogForge
 	{
 	public:
 
-		explicit PrefixPrinter(Printer realPrinter, SeverityPrefixes severityPrefixes = DefaultSeverityPrefixes) noexcept :
+		explicit PrefixPrinter(Printer realPrinter, LogForge::SeverityPrefixes severityPrefixes = DefaultSeverityPrefixes) noexcept :
 			RealPrinter(std::move(realPrinter)),
 			SeverityPrefixes(std::move(severityPrefixes)),
 			LongestPrefixLength(GetLongestPrefixLength(SeverityPrefixes | std::ranges::views::values))
 		{}
 
-		[[nodiscard]] Lines Print(const LogEvent& event) const override
+		void Print(const LogEvent& event, LineBuffer& output) const override
 		{
-			auto printedLines = RealPrinter.Print(event);
+			const auto firstLine = output.LineCount();
+			RealPrinter.Print(event, output);
+
 			const auto prefix = GetPrefixForSeverity(event.Severity);
-			if (not prefix.has_value()) return printedLines;
+			if (prefix == nullptr) return;
 
-			const auto spacing = Line(LongestPrefixLength - prefix.value().length(), L' ');
-			const auto prefixedLines = printedLines | std::ranges::views::transform([leading = prefix.value() + spacing](const Line& line)
+			const auto spacing = LongestPrefixLength - prefix->length();
+			for (auto line = firstLine; line < output.LineCount(); ++line)
 			{
-				return leading + line;
-			});
+				output.Prepend(line, spacing, LOGFORGE_TEXT(' '));
+				output.Prepend(line, *prefix);
+			}
+		}
 
-			return { prefixedLines.begin(), prefixedLines.end() };
+		[[nodiscard]] LineReserve GetLineReserve() const noexcept override
+		{
+			return RealPrinter.GetLineReserve() + LineReserve { .Head = LongestPrefixLength };
 		}
 
 	private:
 
-		[[nodiscard]] std::optional<Line> GetPrefixForSeverity(const Severity severity) const
+		[[nodiscard]] const Line* GetPrefixForSeverity(const Severity severity) const
 		{
 			const auto prefix = SeverityPrefixes.find(severity);
-			if (prefix != SeverityPrefixes.end())
+			if (prefix != SeverityPrefixes.end() and prefix->second.has_value())
 			{
-				return prefix->second;
+				return &prefix->second.value();
 			}
 
-			return std::nullopt;
+			return nullptr;
 		}
 
 		[[nodiscard]] static std::size_t GetLongestPrefixLength(const auto& prefixes)
@@ -74,7 +81,7 @@ namespace LogForge
 	public:
 
 		Printer RealPrinter;
-		SeverityPrefixes SeverityPrefixes;
+		LogForge::SeverityPrefixes SeverityPrefixes;
 		std::size_t LongestPrefixLength;
 
 	};
@@ -83,7 +90,7 @@ namespace LogForge
 	{
 	public:
 
-		explicit PrefixPrinterBuilder(SeverityPrefixes severityPrefixes = DefaultSeverityPrefixes) noexcept :
+		explicit PrefixPrinterBuilder(LogForge::SeverityPrefixes severityPrefixes = DefaultSeverityPrefixes) noexcept :
 			SeverityPrefixes(std::move(severityPrefixes))
 		{}
 
@@ -94,7 +101,7 @@ namespace LogForge
 
 	public:
 
-		SeverityPrefixes SeverityPrefixes;
+		LogForge::SeverityPrefixes SeverityPrefixes;
 
 	};
 
@@ -9,7 +9,7 @@ namespace LogForge
 
 	template <typename Printer, typename PrinterBuilder> requires requires(Printer printer, PrinterBuilder builder)
 	{
-		std::derived_from<Printer, LogPrinter>;
+		requires std::derived_from<Printer, LogPrinter>;
 		{ builder.Build(printer) } -> std::derived_from<LogPrinter>;
 	}
 	constexpr auto operator >> (Printer printer, PrinterBuilder builder) noexcept
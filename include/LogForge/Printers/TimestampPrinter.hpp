@@ -1,14 +1,13 @@
 #pragma once
 
 #include "../LogPrinter.hpp"
-
-#include <sstream>
+#include "../Time/TimeFormatter.hpp"
 
 namespace LogForge
 {
 
-	inline static constexpr auto DefaultTimeFormat = L"%d.%m.%Y %H:%M:%S";
-	inline static constexpr auto DefaultTimePrefix = L"Time: ";
+	inline static constexpr auto DefaultTimeFormat = LOGFORGE_TEXT("%d.%m.%Y %H:%M:%S");
+	inline static constexpr auto DefaultTimePrefix = LOGFORGE_TEXT("Time: ");
 
 	template <std::derived_from<LogPrinter> Printer>
 	class TimestampPrinter final : public LogPrinter
@@ -19,42 +18,30 @@ namespace LogForge
 			Printer realPrinter,
 			Line timeFormat = DefaultTimeFormat,
 			Line timePrefix = DefaultTimePrefix
-		) noexcept :
+		) :
 			RealPrinter(std::move(realPrinter)),
 			TimeFormat(std::move(timeFormat)),
 			Prefix(std::move(timePrefix))
 		{}
 
-		[[nodiscard]] Lines Print(const LogEvent& event) const override
+		void Print(const LogEvent& event, LineBuffer& output) const override
 		{
-			auto printedLines = RealPrinter.Print(event);
-			const auto timeline = FormatTime(event.Time).value_or(L"<Invalid Time>");
-			const auto prefixedTimeline = Prefix + timeline;
-
-			Lines output;
-			output.reserve(printedLines.size() + 1);
-			output.insert(output.begin(), prefixedTimeline);
-			output.insert(output.end(), printedLines.begin(), printedLines.end());
-			return output;
-		}
+			const auto firstLine = output.LineCount();
+			RealPrinter.Print(event, output);
 
-	private:
+			const auto timeLine = output.InsertLine(firstLine, Prefix);
+			output.Append(timeLine, TimeFormat.Format(event.Time).value_or(LOGFORGE_TEXT("<Invalid Time>")));
+		}
 
-		[[nodiscard]] std::optional<Line> FormatTime(const TimePoint& timePoint) const
+		[[nodiscard]] LineReserve GetLineReserve() const noexcept override
 		{
-			const auto time = Clock::to_time_t(timePoint);
-			std::tm timeInfo;
-			if (localtime_s(&timeInfo, &time) != 0) return std::nullopt;
-
-			std::wostringstream wss;
-			wss << std::put_time(&timeInfo, TimeFormat.c_str());
-			return wss.str();
+			return RealPrinter.GetLineReserve();
 		}
 
 	public:
 
 		Printer RealPrinter;
-		Line TimeFormat;
+		TimeFormatter TimeFormat;
 		Line Prefix;
 
 	};
@@ -66,7 +53,7 @@ namespace LogForge
 		constexpr explicit TimestampPrinterBuilder(
 			Line timeFormat = DefaultTimeFormat,
 			Line prefix = DefaultTimePrefix
-		) noexcept :
+		) :
 			TimeFormat(std::move(timeFormat)),
 			Prefix(std::move(prefix))
 		{}
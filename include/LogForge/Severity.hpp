@@ -1,5 +1,12 @@
 #pragma once
 
+/// Lowest severity that is compiled into the program. Every logging call below
+/// it is removed at compile time. Define it as one of the Severity enumerator names,
+/// e.g. `-DLOGFORGE_MIN_SEVERITY=Info`.
+#ifndef LOGFORGE_MIN_SEVERITY
+#define LOGFORGE_MIN_SEVERITY Trace
+#endif
+
 namespace LogForge
 {
 
@@ -14,4 +21,13 @@ namespace LogForge
 		Fatal,		///< Fatal Severity
 	};
 
+	/// Lowest severity that is compiled into the program
+	inline constexpr Severity CompiledMinSeverity = Severity::LOGFORGE_MIN_SEVERITY;
+
+	/// Returns true if logging calls of the given severity are compiled into the program
+	[[nodiscard]] constexpr bool IsCompiledIn(const Severity severity) noexcept
+	{
+		return severity >= CompiledMinSeverity;
+	}
+
 }
\ No newline at end of file
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <cstdint>
+#include <source_location>
+#include <string_view>
+
+/// Source file names are stored as the compiler reports them, usually as absolute paths.
+/// Define LOGFORGE_SOURCE_ROOT as a string literal to strip that directory from the front of
+/// every file name, e.g. `-DLOGFORGE_SOURCE_ROOT="/home/build/project/"`. Define
+/// LOGFORGE_SOURCE_BASENAME to keep only the name of the file instead.
+/// Both are applied at compile time for every logging call.
+#ifndef LOGFORGE_SOURCE_ROOT
+#define LOGFORGE_SOURCE_ROOT ""
+#endif
+
+namespace LogForge
+{
+
+	/// Directory that is stripped from the front of source file names
+	inline constexpr std::string_view SourceRoot = LOGFORGE_SOURCE_ROOT;
+
+	/// True if only the name of source files is kept
+#ifdef LOGFORGE_SOURCE_BASENAME
+	inline constexpr bool KeepSourceBasename = true;
+#else
+	inline constexpr bool KeepSourceBasename = false;
+#endif
+
+	[[nodiscard]] constexpr bool IsPathSeparator(const char character) noexcept
+	{
+		return character == '/' or character == '\\';
+	}
+
+	/// Returns the part of the path behind its last separator
+	[[nodiscard]] constexpr const char* GetSourceBasename(const char* path) noexcept
+	{
+		const char* basename = path;
+		for (const char* current = path; *current != '\0'; ++current)
+		{
+			if (IsPathSeparator(*current)) basename = current + 1;
+		}
+
+		return basename;
+	}
+
+	/// Returns the path relative to the given root directory, or the path itself if it is not inside it.
+	/// Both kinds of separators are treated alike, so a root written with '/' also matches Windows paths.
+	[[nodiscard]] constexpr const char* StripSourceRoot(const char* path, const std::string_view root) noexcept
+	{
+		if (root.empty()) return path;
+
+		for (std::size_t i = 0; i < root.length(); ++i)
+		{
+			if (path[i] == '\0') return path;
+			if (path[i] != root[i] and not (IsPathSeparator(path[i]) and IsPathSeparator(root[i]))) return path;
+		}
+
+		const char* relative = path + root.length();
+		if (IsPathSeparator(root.back())) return relative;
+		if (IsPathSeparator(*relative)) return relative + 1;
+
+		// The root only matched part of a directory name, e.g. "/src" in "/src2/main.cpp"
+		return path;
+	}
+
+	/// Shortens a source file name according to LOGFORGE_SOURCE_ROOT and LOGFORGE_SOURCE_BASENAME.
+	/// The result points into the given string, so it keeps the static storage of compiler-generated names.
+	[[nodiscard]] constexpr const char* TrimSourcePath(const char* path) noexcept
+	{
+		if constexpr (KeepSourceBasename)
+		{
+			return GetSourceBasename(path);
+		}
+		else
+		{
+			return StripSourceRoot(path, SourceRoot);
+		}
+	}
+
+	/// Location of a logging call in the source code.
+	///
+	/// Works like std::source_location, but the file name is already trimmed by
+	/// TrimSourcePath. Converting from std::source_location::current() happens
+	/// at compile time, so printers and outputs never shorten paths themselves.
+	class SourceLocation final
+	{
+	public:
+
+		constexpr SourceLocation() noexcept = default;
+
+		/// Converts the location of a call site. Only accepts constant locations,
+		/// such as `std::source_location::current()` in a default argument.
+		/// Use FromRuntime for locations that are only known at run time.
+		consteval SourceLocation(const std::source_location& location) noexcept :
+			SourceLocation(FromRuntime(location))
+		{}
+
+		/// Converts a location that is not a constant expression, e.g. one that a wrapper
+		/// function received as a parameter. The file name is trimmed on every call.
+		[[nodiscard]] static constexpr SourceLocation FromRuntime(const std::source_location& location) noexcept
+		{
+			return SourceLocation(TrimSourcePath(location.file_name()), location.function_name(), location.line(), location.column());
+		}
+
+		/// Creates a location from names that are already in their final form, e.g. when reading them back from a file.
+		/// The strings must outlive the location.
+		constexpr SourceLocation(const char* fileName, const char* functionName, const std::uint_least32_t line, const std::uint_least32_t column = 0) noexcept :
+			m_FileName(fileName),
+			m_FunctionName(functionName),
+			m_Line(line),
+			m_Column(column)
+		{}
+
+		[[nodiscard]] constexpr const char* file_name() const noexcept { return m_FileName; }
+		[[nodiscard]] constexpr const char* function_name() const noexcept { return m_FunctionName; }
+		[[nodiscard]] constexpr std::uint_least32_t line() const noexcept { return m_Line; }
+		[[nodiscard]] constexpr std::uint_least32_t column() const noexcept { return m_Column; }
+
+	private:
+
+		const char* m_FileName = "";
+		const char* m_FunctionName = "";
+		std::uint_least32_t m_Line = 0;
+		std::uint_least32_t m_Column = 0;
+
+	};
+
+}
@@ -0,0 +1,545 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <iterator>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace LogForge
+{
+
+	/// Calendar helpers for the proleptic Gregorian calendar, counted in days since 1970-01-01
+	struct CivilDate
+	{
+		std::int64_t Year;
+		unsigned Month;	///< 1 to 12
+		unsigned Day;	///< 1 to 31
+
+		[[nodiscard]] static constexpr std::int64_t ToDays(std::int64_t year, const unsigned month, const unsigned day) noexcept
+		{
+			year -= month <= 2;
+			const std::int64_t era = (year >= 0 ? year : year - 399) / 400;
+			const auto yearOfEra = static_cast<unsigned>(year - era * 400);
+			const unsigned dayOfYear = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+			const unsigned dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+			return era * 146097 + static_cast<std::int64_t>(dayOfEra) - 719468;
+		}
+
+		[[nodiscard]] static constexpr CivilDate FromDays(std::int64_t days) noexcept
+		{
+			days += 719468;
+			const std::int64_t era = (days >= 0 ? days : days - 146096) / 146097;
+			const auto dayOfEra = static_cast<unsigned>(days - era * 146097);
+			const unsigned yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+			const unsigned dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+			const unsigned monthIndex = (5 * dayOfYear + 2) / 153;
+			const unsigned day = dayOfYear - (153 * monthIndex + 2) / 5 + 1;
+			const unsigned month = monthIndex < 10 ? monthIndex + 3 : monthIndex - 9;
+			return { static_cast<std::int64_t>(yearOfEra) + era * 400 + (month <= 2), month, day };
+		}
+
+		/// Returns the weekday of the given day, 0 being Sunday
+		[[nodiscard]] static constexpr unsigned GetWeekday(const std::int64_t days) noexcept
+		{
+			return static_cast<unsigned>(days >= -4 ? (days + 4) % 7 : (days + 5) % 7 + 6);
+		}
+
+		[[nodiscard]] static constexpr bool IsLeapYear(const std::int64_t year) noexcept
+		{
+			return year % 4 == 0 and (year % 100 != 0 or year % 400 == 0);
+		}
+
+		[[nodiscard]] static constexpr unsigned GetDaysInMonth(const std::int64_t year, const unsigned month) noexcept
+		{
+			constexpr unsigned days[] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+			return month == 2 and IsLeapYear(year) ? 29 : days[month - 1];
+		}
+	};
+
+	/// Time zone rules read once from a TZif file (RFC 8536) or a POSIX TZ string.
+	///
+	/// Converting a time point only searches the transition table and does calendar
+	/// arithmetic, so it takes no lock and never touches the file system again.
+	/// Times after the last transition follow the POSIX rule from the file footer.
+	class TimeZone final
+	{
+	public:
+
+		/// Offset from UTC that applies at a point in time
+		struct Offset
+		{
+			std::int32_t UtcOffset;		///< Seconds east of UTC
+			bool IsDaylightSaving;		///< True during daylight saving time
+			const char* Abbreviation;	///< Abbreviation such as "CET"
+		};
+
+		/// Loads the zone the process runs in, honoring the TZ environment variable like tzset() does
+		[[nodiscard]] static std::optional<TimeZone> LoadLocal()
+		{
+			const char* tz = std::getenv("TZ");
+			if (tz == nullptr) return LoadFile("/etc/localtime");
+
+			std::string_view name = tz;
+			if (name.empty()) return FromPosixRule("UTC0");
+			if (name.front() == ':') name.remove_prefix(1);
+			if (name.starts_with('/')) return LoadFile(std::string(name));
+
+			const char* directory = std::getenv("TZDIR");
+			auto path = std::string(directory != nullptr ? directory : "/usr/share/zoneinfo");
+			path += '/';
+			path += name;
+
+			if (auto zone = LoadFile(path)) return zone;
+			return FromPosixRule(name);
+		}
+
+		/// Loads a TZif file
+		[[nodiscard]] static std::optional<TimeZone> LoadFile(const std::string& path)
+		{
+			std::ifstream file(path, std::ios::binary);
+			if (not file) return std::nullopt;
+
+			const std::string data { std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>() };
+			return Parse(data);
+		}
+
+		/// Builds a zone from a POSIX TZ string such as "CET-1CEST,M3.5.0,M10.5.0/3"
+		[[nodiscard]] static std::optional<TimeZone> FromPosixRule(const std::string_view rule)
+		{
+			TimeZone zone;
+			if (not zone.ParsePosixRule(rule)) return std::nullopt;
+			return zone;
+		}
+
+		[[nodiscard]] Offset GetOffset(const std::int64_t utcSeconds) const noexcept
+		{
+			if (m_Rule.has_value() and (m_Transitions.empty() or utcSeconds >= m_Transitions.back()))
+			{
+				return ToOffset(m_Rule->GetType(utcSeconds));
+			}
+
+			if (m_Types.empty()) return { 0, false, "UTC" };
+
+			const auto next = std::ranges::upper_bound(m_Transitions, utcSeconds);
+			if (next == m_Transitions.begin()) return ToOffset(0);
+
+			return ToOffset(m_TransitionTypes[static_cast<std::size_t>(next - m_Transitions.begin() - 1)]);
+		}
+
+		[[nodiscard]] std::tm ToLocalTime(const std::int64_t utcSeconds) const noexcept
+		{
+			const auto offset = GetOffset(utcSeconds);
+			const auto localSeconds = utcSeconds + offset.UtcOffset;
+
+			const auto days = localSeconds >= 0 ? localSeconds / 86400 : (localSeconds - 86399) / 86400;
+			const auto secondOfDay = static_cast<int>(localSeconds - days * 86400);
+			const auto date = CivilDate::FromDays(days);
+
+			std::tm result = {};
+			result.tm_sec = secondOfDay % 60;
+			result.tm_min = secondOfDay / 60 % 60;
+			result.tm_hour = secondOfDay / 3600;
+			result.tm_mday = static_cast<int>(date.Day);
+			result.tm_mon = static_cast<int>(date.Month) - 1;
+			result.tm_year = static_cast<int>(date.Year - 1900);
+			result.tm_wday = static_cast<int>(CivilDate::GetWeekday(days));
+			result.tm_yday = static_cast<int>(days - CivilDate::ToDays(date.Year, 1, 1));
+			result.tm_isdst = offset.IsDaylightSaving ? 1 : 0;
+			SetZoneFields(result, offset);
+			return result;
+		}
+
+	private:
+
+		struct Type
+		{
+			std::int32_t UtcOffset;
+			bool IsDaylightSaving;
+			std::size_t AbbreviationIndex;
+		};
+
+		/// Date and time of a daylight saving switch in a POSIX rule
+		struct RuleDate
+		{
+			enum class Kind { Julian, ZeroBasedJulian, MonthWeekDay };
+
+			Kind Kind = Kind::MonthWeekDay;
+			unsigned Day = 0;
+			unsigned Week = 0;
+			unsigned Month = 0;
+			std::int32_t Time = 2 * 3600;
+
+			/// Returns the day the switch happens on in the given year, in days since 1970-01-01
+			[[nodiscard]] std::int64_t GetDay(const std::int64_t year) const noexcept
+			{
+				const auto firstDayOfYear = CivilDate::ToDays(year, 1, 1);
+				switch (Kind)
+				{
+					case Kind::Julian:
+						return firstDayOfYear + Day - 1 + (CivilDate::IsLeapYear(year) and Day >= 60 ? 1 : 0);
+					case Kind::ZeroBasedJulian:
+						return firstDayOfYear + Day;
+					case Kind::MonthWeekDay:
+					default:
+					{
+						const auto firstDayOfMonth = CivilDate::ToDays(year, Month, 1);
+						auto dayOfMonth = 1 + (Day + 7 - CivilDate::GetWeekday(firstDayOfMonth)) % 7 + (Week - 1) * 7;
+						while (dayOfMonth > CivilDate::GetDaysInMonth(year, Month)) dayOfMonth -= 7;
+						return firstDayOfMonth + dayOfMonth - 1;
+					}
+				}
+			}
+		};
+
+		/// Daylight saving rule that applies after the last transition
+		struct Rule
+		{
+			std::size_t StandardType;
+			std::size_t DaylightType;
+			std::int32_t StandardOffset;
+			std::int32_t DaylightOffset;
+			RuleDate Start;
+			RuleDate End;
+
+			[[nodiscard]] std::size_t GetType(const std::int64_t utcSeconds) const noexcept
+			{
+				if (StandardType == DaylightType) return StandardType;
+				return IsDaylightSaving(utcSeconds) ? DaylightType : StandardType;
+			}
+
+			[[nodiscard]] bool IsDaylightSaving(const std::int64_t utcSeconds) const noexcept
+			{
+				const auto localSeconds = utcSeconds + StandardOffset;
+				const auto year = CivilDate::FromDays(localSeconds >= 0 ? localSeconds / 86400 : (localSeconds - 86399) / 86400).Year;
+
+				// The start is given in standard time, the end in daylight saving time
+				const auto start = Start.GetDay(year) * 86400 + Start.Time - StandardOffset;
+				const auto end = End.GetDay(year) * 86400 + End.Time - DaylightOffset;
+
+				return start < end
+					? utcSeconds >= start and utcSeconds < end
+					: utcSeconds < end or utcSeconds >= start;
+			}
+		};
+
+		[[nodiscard]] Offset ToOffset(const std::size_t typeIndex) const noexcept
+		{
+			const auto& type = m_Types[typeIndex];
+			return { type.UtcOffset, type.IsDaylightSaving, m_Abbreviations.c_str() + type.AbbreviationIndex };
+		}
+
+		template <typename Time>
+		static void SetZoneFields([[maybe_unused]] Time& time, [[maybe_unused]] const Offset& offset) noexcept
+		{
+			if constexpr (requires { time.tm_gmtoff; time.tm_zone; })
+			{
+				time.tm_gmtoff = offset.UtcOffset;
+				time.tm_zone = offset.Abbreviation;
+			}
+		}
+
+		[[nodiscard]] static std::optional<TimeZone> Parse(const std::string_view data)
+		{
+			constexpr std::size_t HeaderSize = 44;
+			if (data.size() < HeaderSize or not data.starts_with("TZif")) return std::nullopt;
+
+			TimeZone zone;
+			auto header = ReadHeader(data);
+			auto block = data.substr(HeaderSize);
+
+			// Version 2 and later repeat the data with 64-bit times after the 32-bit block
+			const bool hasVersion2Data = data[4] >= '2';
+			if (hasVersion2Data)
+			{
+				const auto version1Size = GetBlockSize(header, 4);
+				if (block.size() < version1Size + HeaderSize) return std::nullopt;
+
+				header = ReadHeader(block.substr(version1Size));
+				block = block.substr(version1Size + HeaderSize);
+			}
+
+			const std::size_t timeSize = hasVersion2Data ? 8 : 4;
+			if (block.size() < GetBlockSize(header, timeSize)) return std::nullopt;
+
+			std::size_t position = 0;
+			for (std::uint32_t i = 0; i < header.TransitionCount; ++i, position += timeSize)
+			{
+				zone.m_Transitions.push_back(timeSize == 8 ? static_cast<std::int64_t>(ReadBigEndian<std::uint64_t>(block, position)) : static_cast<std::int32_t>(ReadBigEndian<std::uint32_t>(block, position)));
+			}
+
+			for (std::uint32_t i = 0; i < header.TransitionCount; ++i, ++position)
+			{
+				const auto typeIndex = static_cast<std::uint8_t>(block[position]);
+				if (typeIndex >= header.TypeCount) return std::nullopt;
+				zone.m_TransitionTypes.push_back(typeIndex);
+			}
+
+			for (std::uint32_t i = 0; i < header.TypeCount; ++i, position += 6)
+			{
+				zone.m_Types.push_back({
+					.UtcOffset = static_cast<std::int32_t>(ReadBigEndian<std::uint32_t>(block, position)),
+					.IsDaylightSaving = block[position + 4] != 0,
+					.AbbreviationIndex = static_cast<std::uint8_t>(block[position + 5])
+				});
+			}
+
+			zone.m_Abbreviations = std::string(block.substr(position, header.AbbreviationSize));
+			for (const auto& type : zone.m_Types)
+			{
+				if (type.AbbreviationIndex >= zone.m_Abbreviations.size()) return std::nullopt;
+			}
+
+			if (hasVersion2Data)
+			{
+				auto footer = block.substr(GetBlockSize(header, timeSize));
+				if (footer.size() >= 2 and footer.front() == '\n')
+				{
+					footer.remove_prefix(1);
+					footer = footer.substr(0, footer.find('\n'));
+					if (not footer.empty()) zone.ParsePosixRule(footer);
+				}
+			}
+
+			if (zone.m_Types.empty() and not zone.m_Rule.has_value()) return std::nullopt;
+			return zone;
+		}
+
+		struct Header
+		{
+			std::uint32_t UtIndicatorCount;
+			std::uint32_t StandardIndicatorCount;
+			std::uint32_t LeapSecondCount;
+			std::uint32_t TransitionCount;
+			std::uint32_t TypeCount;
+			std::uint32_t AbbreviationSize;
+		};
+
+		[[nodiscard]] static Header ReadHeader(const std::string_view data) noexcept
+		{
+			return {
+				.UtIndicatorCount = ReadBigEndian<std::uint32_t>(data, 20),
+				.StandardIndicatorCount = ReadBigEndian<std::uint32_t>(data, 24),
+				.LeapSecondCount = ReadBigEndian<std::uint32_t>(data, 28),
+				.TransitionCount = ReadBigEndian<std::uint32_t>(data, 32),
+				.TypeCount = ReadBigEndian<std::uint32_t>(data, 36),
+				.AbbreviationSize = ReadBigEndian<std::uint32_t>(data, 40)
+			};
+		}
+
+		[[nodiscard]] static std::size_t GetBlockSize(const Header& header, const std::size_t timeSize) noexcept
+		{
+			return std::size_t(header.TransitionCount) * (timeSize + 1)
+				+ std::size_t(header.TypeCount) * 6
+				+ header.AbbreviationSize
+				+ std::size_t(header.LeapSecondCount) * (timeSize + 4)
+				+ header.StandardIndicatorCount
+				+ header.UtIndicatorCount;
+		}
+
+		template <typename T>
+		[[nodiscard]] static T ReadBigEndian(const std::string_view data, const std::size_t position) noexcept
+		{
+			T value = 0;
+			for (std::size_t i = 0; i < sizeof(T); ++i)
+			{
+				value = static_cast<T>((value << 8) | static_cast<std::uint8_t>(data[position + i]));
+			}
+
+			return value;
+		}
+
+		/// Parses "std offset [dst [offset] [,start[/time],end[/time]]]" and stores the result as rule
+		bool ParsePosixRule(std::string_view rule)
+		{
+			const auto standardName = ParseName(rule);
+			const auto standardOffset = ParseTime(rule);
+			if (standardName.empty() or not standardOffset.has_value()) return false;
+
+			const auto standardType = AddType(-standardOffset.value(), false, standardName);
+
+			const auto daylightName = ParseName(rule);
+			if (daylightName.empty())
+			{
+				// Without daylight saving time the rule is a fixed offset
+				m_Rule = Rule { standardType, standardType, -standardOffset.value(), -standardOffset.value(), {}, {} };
+				return rule.empty();
+			}
+
+			auto daylightOffset = -standardOffset.value() + 3600;
+			if (not rule.empty() and rule.front() != ',')
+			{
+				const auto offset = ParseTime(rule);
+				if (not offset.has_value()) return false;
+				daylightOffset = -offset.value();
+			}
+
+			const auto daylightType = AddType(daylightOffset, true, daylightName);
+
+			// POSIX leaves the default rule to the implementation; this is the one glibc uses
+			RuleDate start { .Kind = RuleDate::Kind::MonthWeekDay, .Day = 0, .Week = 2, .Month = 3 };
+			RuleDate end { .Kind = RuleDate::Kind::MonthWeekDay, .Day = 0, .Week = 1, .Month = 11 };
+
+			if (not rule.empty())
+			{
+				if (rule.front() != ',') return false;
+				rule.remove_prefix(1);
+				if (not ParseRuleDate(rule, start) or rule.empty() or rule.front() != ',') return false;
+				rule.remove_prefix(1);
+				if (not ParseRuleDate(rule, end) or not rule.empty()) return false;
+			}
+
+			m_Rule = Rule { standardType, daylightType, -standardOffset.value(), daylightOffset, start, end };
+			return true;
+		}
+
+		std::size_t AddType(const std::int32_t utcOffset, const bool isDaylightSaving, const std::string_view abbreviation)
+		{
+			const auto abbreviationIndex = m_Abbreviations.size();
+			m_Abbreviations += abbreviation;
+			m_Abbreviations += '\0';
+
+			m_Types.push_back({ utcOffset, isDaylightSaving, abbreviationIndex });
+			return m_Types.size() - 1;
+		}
+
+		[[nodiscard]] static std::string_view ParseName(std::string_view& rule) noexcept
+		{
+			if (rule.starts_with('<'))
+			{
+				const auto end = rule.find('>');
+				if (end == std::string_view::npos) return {};
+
+				const auto name = rule.substr(1, end - 1);
+				rule.remove_prefix(end + 1);
+				return name;
+			}
+
+			std::size_t length = 0;
+			while (length < rule.size() and ((rule[length] >= 'A' and rule[length] <= 'Z') or (rule[length] >= 'a' and rule[length] <= 'z'))) ++length;
+
+			const auto name = rule.substr(0, length);
+			rule.remove_prefix(length);
+			return name;
+		}
+
+		/// Parses "[+|-]hh[:mm[:ss]]" and returns the value in seconds
+		[[nodiscard]] static std::optional<std::int32_t> ParseTime(std::string_view& rule) noexcept
+		{
+			std::int32_t sign = 1;
+			if (rule.starts_with('+') or rule.starts_with('-'))
+			{
+				sign = rule.front() == '-' ? -1 : 1;
+				rule.remove_prefix(1);
+			}
+
+			std::int32_t seconds = 0;
+			for (std::int32_t part = 0, factor = 3600; part < 3; ++part, factor /= 60)
+			{
+				if (part > 0)
+				{
+					if (not rule.starts_with(':')) break;
+					rule.remove_prefix(1);
+				}
+
+				std::size_t digits = 0;
+				std::int32_t value = 0;
+				while (digits < rule.size() and rule[digits] >= '0' and rule[digits] <= '9')
+				{
+					value = value * 10 + (rule[digits++] - '0');
+				}
+
+				if (digits == 0) return std::nullopt;
+				rule.remove_prefix(digits);
+				seconds += value * factor;
+			}
+
+			return sign * seconds;
+		}
+
+		[[nodiscard]] static bool ParseRuleDate(std::string_view& rule, RuleDate& date) noexcept
+		{
+			const auto parseNumber = [&rule](unsigned& value)
+			{
+				std::size_t digits = 0;
+				value = 0;
+				while (digits < rule.size() and rule[digits] >= '0' and rule[digits] <= '9')
+				{
+					value = value * 10 + static_cast<unsigned>(rule[digits++] - '0');
+				}
+
+				rule.remove_prefix(digits);
+				return digits > 0;
+			};
+
+			if (rule.starts_with('M'))
+			{
+				rule.remove_prefix(1);
+				date.Kind = RuleDate::Kind::MonthWeekDay;
+				if (not parseNumber(date.Month) or not rule.starts_with('.')) return false;
+				rule.remove_prefix(1);
+				if (not parseNumber(date.Week) or not rule.starts_with('.')) return false;
+				rule.remove_prefix(1);
+				if (not parseNumber(date.Day)) return false;
+				if (date.Month < 1 or date.Month > 12 or date.Week < 1 or date.Week > 5 or date.Day > 6) return false;
+			}
+			else if (rule.starts_with('J'))
+			{
+				rule.remove_prefix(1);
+				date.Kind = RuleDate::Kind::Julian;
+				if (not parseNumber(date.Day) or date.Day < 1 or date.Day > 365) return false;
+			}
+			else
+			{
+				date.Kind = RuleDate::Kind::ZeroBasedJulian;
+				if (not parseNumber(date.Day) or date.Day > 365) return false;
+			}
+
+			date.Time = 2 * 3600;
+			if (rule.starts_with('/'))
+			{
+				rule.remove_prefix(1);
+				const auto time = ParseTime(rule);
+				if (not time.has_value()) return false;
+				date.Time = time.value();
+			}
+
+			return true;
+		}
+
+		std::vector<std::int64_t> m_Transitions;
+		std::vector<std::uint8_t> m_TransitionTypes;
+		std::vector<Type> m_Types;
+		std::string m_Abbreviations;
+		std::optional<Rule> m_Rule;
+
+	};
+
+	/// Converts a point in time to broken-down local time.
+	///
+	/// On Windows this calls localtime_s. Everywhere else the local zone is loaded
+	/// once and converted with TimeZone, which avoids the global lock that glibc's
+	/// localtime_r takes on every call. Changes to TZ or the zone files after the
+	/// first call are not picked up.
+	[[nodiscard]] inline std::optional<std::tm> ToLocalTime(const std::time_t time)
+	{
+		std::tm result = {};
+
+	#if defined(_WIN32)
+		if (localtime_s(&result, &time) != 0) return std::nullopt;
+		return result;
+	#else
+		static const std::optional<TimeZone> localZone = TimeZone::LoadLocal();
+		if (localZone.has_value()) return localZone->ToLocalTime(static_cast<std::int64_t>(time));
+
+		if (localtime_r(&time, &result) == nullptr) return std::nullopt;
+		return result;
+	#endif
+	}
+
+}
@@ -0,0 +1,324 @@
+#pragma once
+
+#include "../Types.hpp"
+#include "LocalTime.hpp"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ctime>
+#include <initializer_list>
+#include <iomanip>
+#include <optional>
+#include <sstream>
+#include <vector>
+
+namespace LogForge
+{
+
+	/// Formats time points in local time with a strftime-style pattern.
+	///
+	/// The pattern is compiled into a list of steps when the formatter is created.
+	/// Numeric fields (`%Y %y %m %d %e %j %H %I %M %S %F %T %R %D %z`) and literal
+	/// text are written directly; every other field, such as the locale-dependent
+	/// names, is passed to std::put_time.
+	/// `%3N`, `%6N` and `%9N` (or `%N`) print milli-, micro- and nanoseconds, and
+	/// `%:z` prints the UTC offset as `+hh:mm`.
+	///
+	/// The text for one second is rendered once per thread and kept in a small
+	/// thread-local cache. Following events in the same second only copy the
+	/// cached text and patch the sub-second digits.
+	class TimeFormatter final
+	{
+	public:
+
+		explicit TimeFormatter(Line pattern) :
+			m_Pattern(std::move(pattern)),
+			m_Steps(Compile(m_Pattern)),
+			m_Id(NextId())
+		{}
+
+		[[nodiscard]] const Line& GetPattern() const noexcept
+		{
+			return m_Pattern;
+		}
+
+		/// Returns the formatted time, or nothing if it cannot be converted to local time.
+		/// The view stays valid until the next call to Format on the same thread.
+		[[nodiscard]] std::optional<LineView> Format(const TimePoint& time) const
+		{
+			const auto second = std::chrono::floor<std::chrono::seconds>(time);
+			auto& entry = GetCacheEntry(second);
+			if (not entry.Valid) return std::nullopt;
+
+			const auto nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(time - second).count();
+			for (const auto& fraction : entry.Fractions)
+			{
+				WriteFraction(entry.Text.data() + fraction.Offset, nanoseconds, fraction.Digits);
+			}
+
+			return LineView(entry.Text);
+		}
+
+	private:
+
+		/// Operation of a compiled pattern
+		enum class StepKind : std::uint8_t
+		{
+			Text,			///< Literal text
+			Year,			///< %Y
+			ShortYear,		///< %y
+			Month,			///< %m
+			Day,			///< %d
+			SpaceDay,		///< %e
+			DayOfYear,		///< %j
+			Hour,			///< %H
+			Hour12,			///< %I
+			Minute,			///< %M
+			Second,			///< %S
+			UtcOffset,		///< %z
+			UtcOffsetColon,	///< %:z
+			Fraction,		///< %3N, %6N, %9N and %N
+			Fallback,		///< Any other field, rendered by std::put_time
+		};
+
+		struct Step
+		{
+			StepKind Kind;
+			int Digits = 0;		///< Number of sub-second digits
+			Line Text = {};		///< Literal text or the field for std::put_time
+		};
+
+		/// Position of a sub-second field inside the cached text
+		struct Fraction
+		{
+			std::size_t Offset;
+			int Digits;
+		};
+
+		struct CacheEntry
+		{
+			std::uint64_t Id = 0;
+			std::chrono::sys_seconds Second;
+			bool Valid = false;
+			Line Text;
+			std::vector<Fraction> Fractions;
+		};
+
+		static constexpr std::size_t CacheSize = 4;
+
+		[[nodiscard]] static std::uint64_t NextId() noexcept
+		{
+			static std::atomic<std::uint64_t> nextId = 1;
+			return nextId.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		[[nodiscard]] static std::vector<Step> Compile(const LineView pattern)
+		{
+			std::vector<Step> steps;
+
+			const auto addText = [&steps](const LineView text)
+			{
+				if (steps.empty() or steps.back().Kind != StepKind::Text) steps.push_back({ StepKind::Text });
+				steps.back().Text += text;
+			};
+
+			const auto addFields = [&steps, &addText](const std::initializer_list<StepKind> kinds, const LineView separator)
+			{
+				for (const auto kind : kinds)
+				{
+					if (kind != *kinds.begin()) addText(separator);
+					steps.push_back({ kind });
+				}
+			};
+
+			for (std::size_t i = 0; i < pattern.length(); ++i)
+			{
+				if (pattern[i] != LOGFORGE_TEXT('%') or i + 1 == pattern.length())
+				{
+					addText(pattern.substr(i, 1));
+					continue;
+				}
+
+				const auto field = pattern[++i];
+				const auto next = i + 1 < pattern.length() ? pattern[i + 1] : LOGFORGE_TEXT('\0');
+
+				if ((field == LOGFORGE_TEXT('3') or field == LOGFORGE_TEXT('6') or field == LOGFORGE_TEXT('9')) and next == LOGFORGE_TEXT('N'))
+				{
+					steps.push_back({ StepKind::Fraction, field - LOGFORGE_TEXT('0') });
+					++i;
+					continue;
+				}
+
+				if (field == LOGFORGE_TEXT(':') and next == LOGFORGE_TEXT('z'))
+				{
+					steps.push_back({ StepKind::UtcOffsetColon });
+					++i;
+					continue;
+				}
+
+				switch (field)
+				{
+					case LOGFORGE_TEXT('%'): addText(LOGFORGE_TEXT("%")); break;
+					case LOGFORGE_TEXT('n'): addText(LOGFORGE_TEXT("\n")); break;
+					case LOGFORGE_TEXT('t'): addText(LOGFORGE_TEXT("\t")); break;
+					case LOGFORGE_TEXT('Y'): steps.push_back({ StepKind::Year }); break;
+					case LOGFORGE_TEXT('y'): steps.push_back({ StepKind::ShortYear }); break;
+					case LOGFORGE_TEXT('m'): steps.push_back({ StepKind::Month }); break;
+					case LOGFORGE_TEXT('d'): steps.push_back({ StepKind::Day }); break;
+					case LOGFORGE_TEXT('e'): steps.push_back({ StepKind::SpaceDay }); break;
+					case LOGFORGE_TEXT('j'): steps.push_back({ StepKind::DayOfYear }); break;
+					case LOGFORGE_TEXT('H'): steps.push_back({ StepKind::Hour }); break;
+					case LOGFORGE_TEXT('I'): steps.push_back({ StepKind::Hour12 }); break;
+					case LOGFORGE_TEXT('M'): steps.push_back({ StepKind::Minute }); break;
+					case LOGFORGE_TEXT('S'): steps.push_back({ StepKind::Second }); break;
+					case LOGFORGE_TEXT('z'): steps.push_back({ StepKind::UtcOffset }); break;
+					case LOGFORGE_TEXT('F'): addFields({ StepKind::Year, StepKind::Month, StepKind::Day }, LOGFORGE_TEXT("-")); break;
+					case LOGFORGE_TEXT('T'): addFields({ StepKind::Hour, StepKind::Minute, StepKind::Second }, LOGFORGE_TEXT(":")); break;
+					case LOGFORGE_TEXT('R'): addFields({ StepKind::Hour, StepKind::Minute }, LOGFORGE_TEXT(":")); break;
+					case LOGFORGE_TEXT('D'): addFields({ StepKind::Month, StepKind::Day, StepKind::ShortYear }, LOGFORGE_TEXT("/")); break;
+					case LOGFORGE_TEXT('N'): steps.push_back({ StepKind::Fraction, 9 }); break;
+
+					case LOGFORGE_TEXT('E'):
+					case LOGFORGE_TEXT('O'):
+						// Modifiers belong to the following field
+						if (next != LOGFORGE_TEXT('\0'))
+						{
+							steps.push_back({ StepKind::Fallback, 0, Line(pattern.substr(i - 1, 3)) });
+							++i;
+							break;
+						}
+						[[fallthrough]];
+
+					default:
+						steps.push_back({ StepKind::Fallback, 0, Line(pattern.substr(i - 1, 2)) });
+						break;
+				}
+			}
+
+			return steps;
+		}
+
+		CacheEntry& GetCacheEntry(const std::chrono::sys_seconds second) const
+		{
+			thread_local std::array<CacheEntry, CacheSize> cache;
+			thread_local std::size_t nextEntry = 0;
+
+			for (auto& entry : cache)
+			{
+				if (entry.Id == m_Id and entry.Second == second) return entry;
+			}
+
+			auto& entry = cache[nextEntry];
+			nextEntry = (nextEntry + 1) % CacheSize;
+
+			entry.Id = m_Id;
+			entry.Second = second;
+			entry.Valid = Render(second, entry);
+			return entry;
+		}
+
+		bool Render(const std::chrono::sys_seconds second, CacheEntry& entry) const
+		{
+			entry.Text.clear();
+			entry.Fractions.clear();
+
+			const auto utcSeconds = Clock::to_time_t(second);
+			const auto localTime = ToLocalTime(utcSeconds);
+			if (not localTime.has_value()) return false;
+
+			const auto& time = localTime.value();
+			auto& output = entry.Text;
+
+			for (const auto& step : m_Steps)
+			{
+				switch (step.Kind)
+				{
+					case StepKind::Text:			output += step.Text; break;
+					case StepKind::Year:			AppendYear(output, time.tm_year + 1900LL); break;
+					case StepKind::ShortYear:		AppendNumber(output, static_cast<unsigned>(((time.tm_year + 1900) % 100 + 100) % 100), 2); break;
+					case StepKind::Month:			AppendNumber(output, static_cast<unsigned>(time.tm_mon + 1), 2); break;
+					case StepKind::Day:				AppendNumber(output, static_cast<unsigned>(time.tm_mday), 2); break;
+					case StepKind::SpaceDay:		AppendNumber(output, static_cast<unsigned>(time.tm_mday), 2, LOGFORGE_TEXT(' ')); break;
+					case StepKind::DayOfYear:		AppendNumber(output, static_cast<unsigned>(time.tm_yday + 1), 3); break;
+					case StepKind::Hour:			AppendNumber(output, static_cast<unsigned>(time.tm_hour), 2); break;
+					case StepKind::Hour12:			AppendNumber(output, static_cast<unsigned>((time.tm_hour + 11) % 12 + 1), 2); break;
+					case StepKind::Minute:			AppendNumber(output, static_cast<unsigned>(time.tm_min), 2); break;
+					case StepKind::Second:			AppendNumber(output, static_cast<unsigned>(time.tm_sec), 2); break;
+					case StepKind::UtcOffset:		AppendUtcOffset(output, GetUtcOffset(time, utcSeconds), LineView()); break;
+					case StepKind::UtcOffsetColon:	AppendUtcOffset(output, GetUtcOffset(time, utcSeconds), LOGFORGE_TEXT(":")); break;
+
+					case StepKind::Fraction:
+						entry.Fractions.push_back({ output.length(), step.Digits });
+						output.append(static_cast<std::size_t>(step.Digits), LOGFORGE_TEXT('0'));
+						break;
+
+					case StepKind::Fallback:
+					{
+						std::basic_ostringstream<Char> stream;
+						stream << std::put_time(&time, step.Text.c_str());
+						output += stream.view();
+						break;
+					}
+				}
+			}
+
+			return true;
+		}
+
+		/// Returns the offset of the local time from UTC in seconds
+		[[nodiscard]] static std::int64_t GetUtcOffset(const std::tm& localTime, const std::time_t utcSeconds) noexcept
+		{
+			const auto localDays = CivilDate::ToDays(localTime.tm_year + 1900LL, static_cast<unsigned>(localTime.tm_mon + 1), static_cast<unsigned>(localTime.tm_mday));
+			const auto localSeconds = localDays * 86400 + localTime.tm_hour * 3600 + localTime.tm_min * 60 + localTime.tm_sec;
+			return localSeconds - static_cast<std::int64_t>(utcSeconds);
+		}
+
+		/// Appends a number, padded to the given width
+		static void AppendNumber(Line& output, std::uint64_t value, const std::size_t width, const Char padding = LOGFORGE_TEXT('0'))
+		{
+			std::array<Char, 20> digits;
+			std::size_t count = 0;
+			do
+			{
+				digits[count++] = static_cast<Char>(LOGFORGE_TEXT('0') + value % 10);
+				value /= 10;
+			} while (value != 0);
+
+			if (count < width) output.append(width - count, padding);
+			while (count > 0) output += digits[--count];
+		}
+
+		static void AppendYear(Line& output, const long long year)
+		{
+			if (year < 0) output += LOGFORGE_TEXT('-');
+			AppendNumber(output, static_cast<std::uint64_t>(year < 0 ? -year : year), 4);
+		}
+
+		static void AppendUtcOffset(Line& output, const std::int64_t offset, const LineView separator)
+		{
+			const auto minutes = static_cast<std::uint64_t>(offset < 0 ? -offset : offset) / 60;
+			output += offset < 0 ? LOGFORGE_TEXT('-') : LOGFORGE_TEXT('+');
+			AppendNumber(output, minutes / 60, 2);
+			output += separator;
+			AppendNumber(output, minutes % 60, 2);
+		}
+
+		static void WriteFraction(Char* output, std::int64_t nanoseconds, const int digits) noexcept
+		{
+			for (int i = digits; i < 9; ++i) nanoseconds /= 10;
+			for (int i = digits - 1; i >= 0; --i)
+			{
+				output[i] = static_cast<Char>(LOGFORGE_TEXT('0') + nanoseconds % 10);
+				nanoseconds /= 10;
+			}
+		}
+
+		Line m_Pattern;
+		std::vector<Step> m_Steps;
+		std::uint64_t m_Id;
+
+	};
+
+}
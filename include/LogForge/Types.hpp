@@ -1,21 +1,37 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <vector>
 #include <chrono>
-#include <source_location>
-#include <variant>
+#include <ostream>
+
+#include "SourceLocation.hpp"
+
+/// Define LOGFORGE_UTF8 to run the whole library on UTF-8 encoded `char` instead of `wchar_t`.
+/// LOGFORGE_TEXT turns a string or character literal into a literal of the selected character type.
+#ifdef LOGFORGE_UTF8
+#define LOGFORGE_TEXT(text) text
+#else
+#define LOGFORGE_TEXT(text) L##text
+#endif
 
 namespace LogForge
 {
 
+	/// Character type of all text handled by the library
+#ifdef LOGFORGE_UTF8
+	typedef char Char;
+#else
+	typedef wchar_t Char;
+#endif
+
 	/// Utility type definitions
-	typedef std::wstring Line;
+	typedef std::basic_string<Char> Line;
+	typedef std::basic_string_view<Char> LineView;
+	typedef std::basic_ostream<Char> OutputStream;
 	typedef std::vector<Line> Lines;
 	typedef std::chrono::system_clock Clock;
 	typedef std::chrono::time_point<Clock> TimePoint;
-	typedef std::source_location SourceLocation;
-
-	typedef std::variant<Line, std::exception> LogMessage;
 
 }
\ No newline at end of file
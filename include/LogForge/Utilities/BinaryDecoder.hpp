@@ -0,0 +1,375 @@
+#pragma once
+
+#include "../Logger.hpp"
+#include "BinaryFormat.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <istream>
+#include <string>
+#include <vector>
+
+namespace LogForge
+{
+
+	/// Reader that turns files written by BinaryOutput back into log events.
+	///
+	/// Events come with their original severity, time, source location and fields, and
+	/// deferred messages keep their format string and raw arguments, so any logger
+	/// and printer chain renders them as if they were logged right now. Strings and
+	/// call sites are kept for the lifetime of the decoder, so printers that cache
+	/// per call site keep working. Exceptions are replayed as the std::exception that
+	/// LogMessage holds, so printers render them as errors like the original events.
+	/// A copied std::exception only keeps its message with Microsoft's standard library;
+	/// elsewhere its what() is the generic text, which is also what was recorded there.
+	///
+	/// Reading stops at the end of the input or at the first malformed record; a file
+	/// that was cut off in the middle of a record, e.g. by a crash, decodes up to there.
+	class BinaryDecoder final
+	{
+	public:
+
+		/// Reads from the given stream, which must be opened in binary mode and outlive the decoder
+		explicit BinaryDecoder(std::istream& stream) noexcept :
+			m_Input(stream.rdbuf())
+		{}
+
+		BinaryDecoder(const BinaryDecoder&) = delete;
+		BinaryDecoder& operator = (const BinaryDecoder&) = delete;
+
+		/// Reads the next event into the given one. Its strings stay valid as long as the decoder.
+		/// Returns false at the end of the input or if the input is malformed, see GetError().
+		[[nodiscard]] bool Next(LogEvent& event)
+		{
+			for (;;)
+			{
+				const auto tag = m_Input != nullptr ? m_Input->sbumpc() : std::char_traits<char>::eof();
+				if (tag == std::char_traits<char>::eof()) return false;
+
+				switch (static_cast<std::uint8_t>(tag))
+				{
+					case static_cast<std::uint8_t>(BinaryRecord::Header):
+						if (not ReadHeader()) return false;
+						break;
+
+					case static_cast<std::uint8_t>(BinaryRecord::String):
+						if (not ReadString()) return false;
+						break;
+
+					case static_cast<std::uint8_t>(BinaryRecord::CallSite):
+						if (not ReadCallSite()) return false;
+						break;
+
+					default:
+						return ReadEvent(static_cast<std::uint8_t>(tag), event);
+				}
+			}
+		}
+
+		/// Passes every remaining event to the logger and returns their number
+		std::size_t Replay(const Logger& logger)
+		{
+			LogEvent event = { Severity::Trace, Line(), TimePoint(), SourceLocation() };
+			std::size_t count = 0;
+
+			while (Next(event))
+			{
+				logger.Log(event);
+				++count;
+			}
+
+			return count;
+		}
+
+		/// Returns a description of the malformed input that stopped decoding, or nullptr if there was none
+		[[nodiscard]] const char* GetError() const noexcept
+		{
+			return m_Error;
+		}
+
+	private:
+
+		/// Strings are stored in both encodings, since source locations need narrow ones
+		struct StringEntry
+		{
+			std::string Narrow;
+			Line Text;
+		};
+
+		[[nodiscard]] bool ReadHeader()
+		{
+			char magic[BinaryMagic.size()];
+			std::uint8_t version = 0;
+			std::uint8_t byteOrder = 0;
+
+			if (not ReadBytes(magic, sizeof(magic)) or not ReadByte(version) or not ReadByte(byteOrder)) return Fail("Truncated header");
+			if (std::memcmp(magic, BinaryMagic.data(), sizeof(magic)) != 0) return Fail("Not a binary log");
+			if (version != BinaryFormatVersion) return Fail("Unsupported format version");
+			if (byteOrder != BinaryNativeByteOrder) return Fail("Written with a different byte order");
+
+			// Every run that appended to the file starts with its own tables
+			m_StringIndices.clear();
+			m_CallSites.clear();
+			m_LastTime = 0;
+			m_HasHeader = true;
+			return true;
+		}
+
+		[[nodiscard]] bool ReadString()
+		{
+			std::uint64_t id = 0;
+			std::uint64_t length = 0;
+			if (not m_HasHeader) return Fail("Missing header");
+			if (not ReadVarint(id) or not ReadVarint(length) or length > MaxStringLength) return Fail("Malformed string record");
+			if (id != m_StringIndices.size()) return Fail("String defined out of order");
+
+			auto& entry = m_Strings.emplace_back();
+			entry.Narrow.resize(static_cast<std::size_t>(length));
+			if (not ReadBytes(entry.Narrow.data(), entry.Narrow.size())) return Fail("Truncated string record");
+
+			AppendFromUtf8(entry.Text, entry.Narrow);
+			m_StringIndices.push_back(m_Strings.size() - 1);
+			return true;
+		}
+
+		[[nodiscard]] bool ReadCallSite()
+		{
+			std::uint64_t id = 0, file = 0, function = 0, line = 0, column = 0;
+			if (not m_HasHeader) return Fail("Missing header");
+			if (not ReadVarint(id) or not ReadVarint(file) or not ReadVarint(function) or not ReadVarint(line) or not ReadVarint(column)) return Fail("Truncated call site record");
+			if (id != m_CallSites.size()) return Fail("Call site defined out of order");
+			if (file >= m_StringIndices.size() or function >= m_StringIndices.size()) return Fail("Call site refers to an unknown string");
+
+			m_CallSites.emplace_back(
+				m_Strings[m_StringIndices[file]].Narrow.c_str(),
+				m_Strings[m_StringIndices[function]].Narrow.c_str(),
+				static_cast<std::uint_least32_t>(line),
+				static_cast<std::uint_least32_t>(column)
+			);
+
+			return true;
+		}
+
+		[[nodiscard]] bool ReadEvent(const std::uint8_t tag, LogEvent& event)
+		{
+			const auto severity = tag & 7;
+			const auto kind = static_cast<BinaryMessageKind>(tag >> 3 & 3);
+			if (not m_HasHeader) return Fail("Missing header");
+			if (tag > MaxBinaryEventTag or kind > BinaryMessageKind::Exception or severity > static_cast<int>(Severity::Fatal)) return Fail("Unknown record");
+
+			std::uint64_t delta = 0;
+			std::uint64_t callSite = 0;
+			if (not ReadVarint(delta) or not ReadVarint(callSite)) return Fail("Truncated event record");
+			if (callSite >= m_CallSites.size()) return Fail("Event refers to an unknown call site");
+
+			m_LastTime += DecodeZigZag(delta);
+			event.Severity = static_cast<Severity>(severity);
+			event.Time = TimePoint(std::chrono::duration_cast<Clock::duration>(std::chrono::nanoseconds(m_LastTime)));
+			event.SourceLocation = m_CallSites[callSite];
+
+			if (kind == BinaryMessageKind::Deferred)
+			{
+				DeferredMessage message;
+				if (not ReadDeferredMessage(message)) return false;
+
+				event.Message = message;
+			}
+			else if (not ReadTextMessage(kind, event))
+			{
+				return false;
+			}
+
+			event.Fields.Clear();
+			return (tag & BinaryFieldsFlag) == 0 or ReadFields(event.Fields);
+		}
+
+		[[nodiscard]] bool ReadTextMessage(const BinaryMessageKind kind, LogEvent& event)
+		{
+			std::uint64_t length = 0;
+			if (not ReadVarint(length) or length > MaxStringLength) return Fail("Malformed event record");
+
+			m_Scratch.resize(static_cast<std::size_t>(length));
+			if (not ReadBytes(m_Scratch.data(), m_Scratch.size())) return Fail("Truncated event record");
+
+			if (kind == BinaryMessageKind::Exception)
+			{
+			#ifdef _MSC_VER
+				event.Message.emplace<std::exception>(m_Scratch.c_str());
+			#else
+				event.Message.emplace<std::exception>();
+			#endif
+				return true;
+			}
+
+			// The text of the previous event is overwritten in place
+			auto* text = std::get_if<Line>(&event.Message);
+			if (text == nullptr) text = &event.Message.emplace<Line>();
+			text->clear();
+
+			AppendFromUtf8(*text, m_Scratch);
+			return true;
+		}
+
+		[[nodiscard]] bool ReadFields(LogFields& fields)
+		{
+			std::uint64_t count = 0;
+			if (not ReadVarint(count)) return Fail("Truncated event record");
+
+			for (std::uint64_t i = 0; i < count; ++i)
+			{
+				std::uint64_t key = 0;
+				std::uint8_t type = 0;
+				if (not ReadVarint(key) or not ReadByte(type)) return Fail("Truncated event record");
+				if (key >= m_StringIndices.size()) return Fail("Field refers to an unknown key");
+				if (type > static_cast<std::uint8_t>(FieldType::String)) return Fail("Unknown field type");
+
+				const auto* name = m_Strings[m_StringIndices[key]].Text.c_str();
+				std::uint64_t value = 0;
+
+				switch (static_cast<FieldType>(type))
+				{
+					case FieldType::Boolean:
+					{
+						std::uint8_t boolean = 0;
+						if (not ReadByte(boolean)) return Fail("Truncated event record");
+						fields.Add(name, boolean != 0);
+						break;
+					}
+
+					case FieldType::Int:
+						if (not ReadVarint(value)) return Fail("Truncated event record");
+						fields.Add(name, DecodeZigZag(value));
+						break;
+
+					case FieldType::UInt:
+						if (not ReadVarint(value)) return Fail("Truncated event record");
+						fields.Add(name, value);
+						break;
+
+					case FieldType::Float:
+					{
+						double number = 0;
+						if (not ReadBytes(reinterpret_cast<char*>(&number), sizeof(number))) return Fail("Truncated event record");
+						fields.Add(name, number);
+						break;
+					}
+
+					case FieldType::String:
+						if (not ReadVarint(value) or value > MaxStringLength) return Fail("Malformed event record");
+
+						m_Scratch.resize(static_cast<std::size_t>(value));
+						if (not ReadBytes(m_Scratch.data(), m_Scratch.size())) return Fail("Truncated event record");
+
+						m_FieldText.clear();
+						AppendFromUtf8(m_FieldText, m_Scratch);
+						fields.Add(name, m_FieldText);
+						break;
+				}
+			}
+
+			return true;
+		}
+
+		[[nodiscard]] bool ReadDeferredMessage(DeferredMessage& message)
+		{
+			std::uint64_t format = 0;
+			std::uint8_t count = 0;
+			if (not ReadVarint(format) or not ReadByte(count)) return Fail("Truncated event record");
+			if (format >= m_StringIndices.size()) return Fail("Event refers to an unknown format string");
+			if (count > DeferredMessage::MaxArguments) return Fail("Too many arguments");
+
+			message.Format = m_Strings[m_StringIndices[format]].Text.c_str();
+			message.ArgumentCount = count;
+
+			for (std::size_t i = 0; i < count; ++i)
+			{
+				std::uint8_t type = 0;
+				if (not ReadByte(type)) return Fail("Truncated event record");
+				if (type > static_cast<std::uint8_t>(ArgumentType::Pointer)) return Fail("Unknown argument type");
+
+				message.ArgumentTypes[i] = static_cast<ArgumentType>(type);
+			}
+
+			std::size_t offset = 0;
+			for (std::size_t i = 0; i < count; ++i)
+			{
+				const auto type = message.ArgumentTypes[i];
+				const auto size = type == ArgumentType::Pointer ? sizeof(const void*) : GetBinaryArgumentSize(type);
+				if (offset + size > DeferredMessage::StorageSize) return Fail("Arguments do not fit into a message");
+
+				if (type == ArgumentType::Pointer)
+				{
+					// Pointers are always stored with 8 bytes
+					std::uint64_t address = 0;
+					if (not ReadBytes(reinterpret_cast<char*>(&address), sizeof(address))) return Fail("Truncated event record");
+
+					const auto* pointer = reinterpret_cast<const void*>(static_cast<std::uintptr_t>(address));
+					std::memcpy(message.Storage.data() + offset, &pointer, sizeof(pointer));
+				}
+				else if (not ReadBytes(reinterpret_cast<char*>(message.Storage.data() + offset), size))
+				{
+					return Fail("Truncated event record");
+				}
+
+				offset += size;
+			}
+
+			return true;
+		}
+
+		[[nodiscard]] bool ReadByte(std::uint8_t& value)
+		{
+			const auto character = m_Input->sbumpc();
+			if (character == std::char_traits<char>::eof()) return false;
+
+			value = static_cast<std::uint8_t>(character);
+			return true;
+		}
+
+		[[nodiscard]] bool ReadBytes(char* data, const std::size_t size)
+		{
+			return m_Input->sgetn(data, static_cast<std::streamsize>(size)) == static_cast<std::streamsize>(size);
+		}
+
+		[[nodiscard]] bool ReadVarint(std::uint64_t& value)
+		{
+			value = 0;
+			for (unsigned shift = 0; shift < 64; shift += 7)
+			{
+				std::uint8_t byte = 0;
+				if (not ReadByte(byte)) return false;
+
+				value |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+				if ((byte & 0x80) == 0) return true;
+			}
+
+			return false;
+		}
+
+		/// Stops decoding with the given description
+		[[nodiscard]] bool Fail(const char* error) noexcept
+		{
+			m_Error = error;
+			m_Input = nullptr;
+			return false;
+		}
+
+		/// Longest string that is accepted, so a corrupt length does not allocate gigabytes
+		static constexpr std::uint64_t MaxStringLength = 64 * 1024 * 1024;
+
+		std::streambuf* m_Input;
+		std::deque<StringEntry> m_Strings;
+		std::vector<std::size_t> m_StringIndices;
+		std::vector<SourceLocation> m_CallSites;
+		std::int64_t m_LastTime = 0;
+		bool m_HasHeader = false;
+		std::string m_Scratch;
+		Line m_FieldText;
+		const char* m_Error = nullptr;
+
+	};
+
+}
@@ -0,0 +1,115 @@
+#pragma once
+
+#include "../LogMessage.hpp"
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace LogForge
+{
+
+	/// Record types of the binary log format written by BinaryOutput and read by BinaryDecoder.
+	///
+	/// A file is a sequence of records that each start with a tag byte. It begins
+	/// with a header record, which may appear again when a later run appends to the
+	/// same file; it resets the string table and the time base. Strings and call
+	/// sites are defined once per header by their own records before the first event
+	/// that refers to them. All integers are unsigned LEB128 varints, text is UTF-8.
+	///
+	/// | Record   | Layout |
+	/// | -------- | ------ |
+	/// | Header   | `7F 'L' 'F' 'B'`, version, 0 for little endian or 1 for big endian |
+	/// | String   | `40`, string ID, byte length, bytes |
+	/// | CallSite | `41`, call site ID, file string ID, function string ID, line, column |
+	/// | Event    | fields flag \| kind << 3 \| severity, zigzag time delta in nanoseconds, call site ID, message, fields |
+	///
+	/// The message of a deferred event is the format string ID, the argument count,
+	/// one ArgumentType byte per argument and the raw argument bytes in the byte order
+	/// of the header, with pointers widened to 8 bytes. Text and exception messages
+	/// are a byte length followed by the text.
+	///
+	/// Fields are only present if the tag has BinaryFieldsFlag set: the field count,
+	/// then per field the key string ID, a FieldType byte and the value. Booleans are
+	/// one byte, integers zigzag or plain varints, floats 8 bytes in the byte order of
+	/// the header and strings a byte length followed by the text.
+	enum class BinaryRecord : std::uint8_t
+	{
+		Event = 0x00,
+		String = 0x40,
+		CallSite = 0x41,
+		Header = 0x7F,
+	};
+
+	/// Kind of message stored in an event record
+	enum class BinaryMessageKind : std::uint8_t
+	{
+		Deferred,
+		Text,
+		Exception,
+	};
+
+	/// Bytes that follow the header tag
+	inline constexpr std::array<char, 3> BinaryMagic = { 'L', 'F', 'B' };
+
+	/// Version of the format written by BinaryOutput
+	inline constexpr std::uint8_t BinaryFormatVersion = 1;
+
+	/// Byte order marker written into the header
+	inline constexpr std::uint8_t BinaryNativeByteOrder = std::endian::native == std::endian::little ? 0 : 1;
+
+	/// Bit of the event tag that marks events with structured fields
+	inline constexpr std::uint8_t BinaryFieldsFlag = 0x20;
+
+	/// Highest event tag; the low three bits hold the severity, the next two the message kind, the next one the fields flag
+	inline constexpr std::uint8_t MaxBinaryEventTag = BinaryFieldsFlag | static_cast<std::uint8_t>(BinaryMessageKind::Exception) << 3 | 7;
+
+	/// Appends an unsigned LEB128 varint to the byte string
+	inline void AppendVarint(std::string& output, std::uint64_t value)
+	{
+		while (value >= 0x80)
+		{
+			output += static_cast<char>(value | 0x80);
+			value >>= 7;
+		}
+
+		output += static_cast<char>(value);
+	}
+
+	/// Maps signed values to unsigned ones so that small magnitudes stay small varints
+	[[nodiscard]] constexpr std::uint64_t EncodeZigZag(const std::int64_t value) noexcept
+	{
+		return (static_cast<std::uint64_t>(value) << 1) ^ static_cast<std::uint64_t>(value >> 63);
+	}
+
+	[[nodiscard]] constexpr std::int64_t DecodeZigZag(const std::uint64_t value) noexcept
+	{
+		return static_cast<std::int64_t>(value >> 1) ^ -static_cast<std::int64_t>(value & 1);
+	}
+
+	/// Returns the number of bytes an argument of the given type takes in the binary format
+	[[nodiscard]] constexpr std::size_t GetBinaryArgumentSize(const ArgumentType type) noexcept
+	{
+		switch (type)
+		{
+			case ArgumentType::Boolean:
+			case ArgumentType::Int8:
+			case ArgumentType::UInt8:		return 1;
+			case ArgumentType::Int16:
+			case ArgumentType::UInt16:		return 2;
+			case ArgumentType::Character:
+			case ArgumentType::Int32:
+			case ArgumentType::UInt32:
+			case ArgumentType::Float:		return 4;
+			case ArgumentType::Int64:
+			case ArgumentType::UInt64:
+			case ArgumentType::Double:
+			case ArgumentType::Pointer:		return 8;
+		}
+
+		return 0;
+	}
+
+}
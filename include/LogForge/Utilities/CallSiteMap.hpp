@@ -0,0 +1,148 @@
+#pragma once
+
+#include "../Types.hpp"
+
+#include <atomic>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+
+namespace LogForge
+{
+
+	/// Structure that identifies a call site by the static data of its source location
+	struct CallSiteKey
+	{
+		const char* File;		///< Pointer to the file name of the call site
+		const char* Function;	///< Pointer to the function name of the call site
+		std::uint_least32_t LineNumber;
+		std::uint_least32_t ColumnNumber;
+
+		[[nodiscard]] static CallSiteKey FromLocation(const SourceLocation& location) noexcept
+		{
+			return { location.file_name(), location.function_name(), location.line(), location.column() };
+		}
+
+		[[nodiscard]] constexpr bool operator == (const CallSiteKey& other) const noexcept = default;
+
+		[[nodiscard]] std::size_t Hash() const noexcept
+		{
+			auto hash = static_cast<std::uint64_t>(reinterpret_cast<std::uintptr_t>(File));
+			hash = hash * 31 + static_cast<std::uint64_t>(reinterpret_cast<std::uintptr_t>(Function));
+			hash = hash * 31 + (static_cast<std::uint64_t>(LineNumber) << 16 | ColumnNumber);
+			return static_cast<std::size_t>((hash * 0x9E3779B97F4A7C15ull) >> 32);
+		}
+	};
+
+	/// Insert-only hash map from call sites to values that never locks.
+	///
+	/// Slots are atomic pointers to immutable entries. Lookups only load them, and
+	/// new entries are published with a compare-and-swap, so threads racing to add
+	/// the same call site agree on one entry. Entries are never removed; once all
+	/// slots are taken, GetOrInsert returns nullptr and callers fall back to
+	/// computing the value themselves.
+	///
+	/// Call sites are compared by the addresses of their file and function names,
+	/// which the compiler keeps fixed for every std::source_location::current() call
+	/// (trimming the file name keeps a fixed offset into the same string).
+	template <typename T>
+	class CallSiteMap final
+	{
+	public:
+
+		static constexpr std::size_t DefaultCapacity = 4096;
+
+		/// Creates a map with room for the given number of call sites, rounded up to a power of two
+		explicit CallSiteMap(const std::size_t capacity = DefaultCapacity) :
+			m_Capacity(std::bit_ceil(capacity < 2 ? std::size_t(2) : capacity)),
+			m_Slots(std::make_unique<std::atomic<Entry*>[]>(m_Capacity))
+		{}
+
+		CallSiteMap(const CallSiteMap&) = delete;
+		CallSiteMap& operator = (const CallSiteMap&) = delete;
+
+		~CallSiteMap()
+		{
+			for (std::size_t i = 0; i < m_Capacity; ++i)
+			{
+				delete m_Slots[i].load(std::memory_order_relaxed);
+			}
+		}
+
+		/// Returns the value for the call site, or nullptr if it has not been added
+		[[nodiscard]] const T* Find(const SourceLocation& location) const noexcept
+		{
+			const auto key = CallSiteKey::FromLocation(location);
+			const auto mask = m_Capacity - 1;
+
+			for (std::size_t probe = 0, slot = key.Hash() & mask; probe < m_Capacity; ++probe, slot = (slot + 1) & mask)
+			{
+				const auto* entry = m_Slots[slot].load(std::memory_order_acquire);
+				if (entry == nullptr) return nullptr;
+				if (entry->Key == key) return &entry->Value;
+			}
+
+			return nullptr;
+		}
+
+		/// Returns the value for the call site and creates it with the factory on first use.
+		/// Returns nullptr if the call site is new and the map is full.
+		template <std::invocable Factory>
+		[[nodiscard]] const T* GetOrInsert(const SourceLocation& location, Factory&& factory)
+		{
+			const auto key = CallSiteKey::FromLocation(location);
+			const auto mask = m_Capacity - 1;
+			std::unique_ptr<Entry> created;
+
+			for (std::size_t probe = 0, slot = key.Hash() & mask; probe < m_Capacity; ++probe, slot = (slot + 1) & mask)
+			{
+				auto* entry = m_Slots[slot].load(std::memory_order_acquire);
+				if (entry == nullptr)
+				{
+					if (created == nullptr)
+					{
+						created = std::make_unique<Entry>(key, std::invoke(std::forward<Factory>(factory)));
+					}
+
+					if (m_Slots[slot].compare_exchange_strong(entry, created.get(), std::memory_order_acq_rel, std::memory_order_acquire))
+					{
+						m_Size.fetch_add(1, std::memory_order_relaxed);
+						return &created.release()->Value;
+					}
+				}
+
+				// Either the slot was taken before, or another thread won the race for it
+				if (entry->Key == key) return &entry->Value;
+			}
+
+			return nullptr;
+		}
+
+		[[nodiscard]] std::size_t Size() const noexcept
+		{
+			return m_Size.load(std::memory_order_relaxed);
+		}
+
+		[[nodiscard]] std::size_t Capacity() const noexcept
+		{
+			return m_Capacity;
+		}
+
+	private:
+
+		struct Entry
+		{
+			CallSiteKey Key;
+			T Value;
+		};
+
+		std::size_t m_Capacity;
+		std::unique_ptr<std::atomic<Entry*>[]> m_Slots;
+		std::atomic<std::size_t> m_Size = 0;
+
+	};
+
+}
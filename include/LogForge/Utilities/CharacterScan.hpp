@@ -0,0 +1,132 @@
+#pragma once
+
+#include "../LineBuffer.hpp"
+#include "../Types.hpp"
+
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#include <emmintrin.h>
+	#define LOGFORGE_SSE2
+#endif
+
+namespace LogForge
+{
+
+	/// Characters that a scan stops at: every code unit below a limit and two more characters
+	struct CharacterSet
+	{
+		Char Below;	///< Code units with a smaller unsigned value are part of the set
+		Char First;	///< Additional character of the set
+		Char Second;	///< Additional character of the set
+
+		[[nodiscard]] constexpr bool Contains(const Char character) const noexcept
+		{
+			using Unit = std::make_unsigned_t<Char>;
+			return static_cast<Unit>(character) < static_cast<Unit>(Below) or character == First or character == Second;
+		}
+	};
+
+	/// Returns the index of the first character at or after the offset that is part of the set,
+	/// or the size of the text if there is none.
+	///
+	/// Where SSE2 is available, 16 bytes are compared at a time, so long runs of
+	/// ordinary characters cost a few instructions per block instead of a branch
+	/// per character. Printers use it to find the next character that needs
+	/// escaping and copy everything in front of it in one go.
+	[[nodiscard]] inline std::size_t FindFirstOf(const LineView text, const CharacterSet& set, std::size_t offset = 0) noexcept
+	{
+	#ifdef LOGFORGE_SSE2
+		constexpr std::size_t BlockSize = sizeof(__m128i) / sizeof(Char);
+
+		if (text.size() >= BlockSize)
+		{
+			// SSE2 only compares signed integers, so flipping the sign bit turns them into unsigned comparisons
+			const auto broadcast = [](const Char character)
+			{
+				if constexpr (sizeof(Char) == 1) return _mm_set1_epi8(static_cast<char>(character));
+				else if constexpr (sizeof(Char) == 2) return _mm_set1_epi16(static_cast<short>(character));
+				else return _mm_set1_epi32(static_cast<int>(character));
+			};
+
+			const auto signBit = broadcast(static_cast<Char>(std::make_unsigned_t<Char>(1) << (sizeof(Char) * 8 - 1)));
+			const auto below = _mm_xor_si128(broadcast(set.Below), signBit);
+			const auto first = broadcast(set.First);
+			const auto second = broadcast(set.Second);
+
+			const auto match = [&](const __m128i block)
+			{
+				const auto biased = _mm_xor_si128(block, signBit);
+
+				if constexpr (sizeof(Char) == 1)
+				{
+					return _mm_or_si128(_mm_cmplt_epi8(biased, below), _mm_or_si128(_mm_cmpeq_epi8(block, first), _mm_cmpeq_epi8(block, second)));
+				}
+				else if constexpr (sizeof(Char) == 2)
+				{
+					return _mm_or_si128(_mm_cmplt_epi16(biased, below), _mm_or_si128(_mm_cmpeq_epi16(block, first), _mm_cmpeq_epi16(block, second)));
+				}
+				else
+				{
+					return _mm_or_si128(_mm_cmplt_epi32(biased, below), _mm_or_si128(_mm_cmpeq_epi32(block, first), _mm_cmpeq_epi32(block, second)));
+				}
+			};
+
+			for (; offset + BlockSize <= text.size(); offset += BlockSize)
+			{
+				const auto block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text.data() + offset));
+				const auto mask = static_cast<unsigned>(_mm_movemask_epi8(match(block)));
+				if (mask != 0) return offset + std::countr_zero(mask) / sizeof(Char);
+			}
+
+			if (offset == text.size()) return offset;
+
+			// The last partial block is compared by loading the final full block again and ignoring what was already seen
+			const auto last = text.size() - BlockSize;
+			const auto block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text.data() + last));
+			const auto mask = static_cast<unsigned>(_mm_movemask_epi8(match(block))) >> ((offset - last) * sizeof(Char));
+			return mask != 0 ? offset + std::countr_zero(mask) / sizeof(Char) : text.size();
+		}
+	#endif
+
+		for (; offset < text.size(); ++offset)
+		{
+			if (set.Contains(text[offset])) return offset;
+		}
+
+		return offset;
+	}
+
+	/// Appends the text to a line of the buffer. Runs of characters outside the set are copied
+	/// in one go, and every character of the set is passed to the escape function instead.
+	template <std::invocable<LineBuffer&, std::size_t, Char> Escape>
+	void AppendEscapedRuns(LineBuffer& output, const std::size_t line, const LineView text, const CharacterSet& set, Escape&& escape)
+	{
+		std::size_t begin = 0;
+		for (auto special = FindFirstOf(text, set); special < text.size(); special = FindFirstOf(text, set, begin))
+		{
+			output.Append(line, text.substr(begin, special - begin));
+			escape(output, line, text[special]);
+			begin = special + 1;
+		}
+
+		output.Append(line, text.substr(begin));
+	}
+
+	/// Appends a code unit below 0x100 as `\u00XX`, the fallback of JSON and logfmt for control characters
+	inline void AppendUnicodeEscape(LineBuffer& output, const std::size_t line, const Char character)
+	{
+		constexpr LineView Digits = LOGFORGE_TEXT("0123456789abcdef");
+		const Char escaped[] = {
+			LOGFORGE_TEXT('\\'), LOGFORGE_TEXT('u'), LOGFORGE_TEXT('0'), LOGFORGE_TEXT('0'),
+			Digits[(character >> 4) & 0xF], Digits[character & 0xF]
+		};
+
+		output.Append(line, LineView(escaped, std::size(escaped)));
+	}
+
+}
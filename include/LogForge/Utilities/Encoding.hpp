@@ -0,0 +1,186 @@
+#pragma once
+
+#include "../Types.hpp"
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace LogForge
+{
+
+	/// Appends a Unicode code point to the string, encoded as UTF-8, UTF-16 or UTF-32 depending on its character type
+	template <typename CharType>
+	void AppendCodePoint(std::basic_string<CharType>& output, const char32_t codePoint)
+	{
+		if constexpr (sizeof(CharType) == 1)
+		{
+			if (codePoint < 0x80)
+			{
+				output += static_cast<CharType>(codePoint);
+			}
+			else if (codePoint < 0x800)
+			{
+				output += static_cast<CharType>(0xC0 | (codePoint >> 6));
+				output += static_cast<CharType>(0x80 | (codePoint & 0x3F));
+			}
+			else if (codePoint < 0x10000)
+			{
+				output += static_cast<CharType>(0xE0 | (codePoint >> 12));
+				output += static_cast<CharType>(0x80 | ((codePoint >> 6) & 0x3F));
+				output += static_cast<CharType>(0x80 | (codePoint & 0x3F));
+			}
+			else
+			{
+				output += static_cast<CharType>(0xF0 | (codePoint >> 18));
+				output += static_cast<CharType>(0x80 | ((codePoint >> 12) & 0x3F));
+				output += static_cast<CharType>(0x80 | ((codePoint >> 6) & 0x3F));
+				output += static_cast<CharType>(0x80 | (codePoint & 0x3F));
+			}
+		}
+		else if constexpr (sizeof(CharType) == 2)
+		{
+			if (codePoint < 0x10000)
+			{
+				output += static_cast<CharType>(codePoint);
+			}
+			else
+			{
+				output += static_cast<CharType>(0xD800 + ((codePoint - 0x10000) >> 10));
+				output += static_cast<CharType>(0xDC00 + ((codePoint - 0x10000) & 0x3FF));
+			}
+		}
+		else
+		{
+			output += static_cast<CharType>(codePoint);
+		}
+	}
+
+	/// Appends the line to a byte string, encoded as UTF-8. Wide lines are read as UTF-16 or
+	/// UTF-32 depending on the size of wchar_t; unpaired surrogates become U+FFFD.
+	inline void AppendUtf8(std::string& output, const LineView line)
+	{
+		if constexpr (sizeof(Char) == 1)
+		{
+			output.append(line.begin(), line.end());
+		}
+		else
+		{
+			// Every UTF-16 unit takes at most three bytes, every UTF-32 unit at most four
+			const auto start = output.size();
+			output.resize(start + line.length() * (sizeof(Char) == 2 ? 3 : 4));
+			auto* target = reinterpret_cast<unsigned char*>(output.data() + start);
+
+			for (std::size_t i = 0; i < line.length(); ++i)
+			{
+				auto codePoint = static_cast<char32_t>(line[i]);
+				if (codePoint < 0x80)
+				{
+					*target++ = static_cast<unsigned char>(codePoint);
+					continue;
+				}
+
+				if (codePoint >= 0xD800 and codePoint <= 0xDFFF)
+				{
+					const auto next = i + 1 < line.length() ? static_cast<char32_t>(line[i + 1]) : char32_t(0);
+					if (sizeof(Char) == 2 and codePoint <= 0xDBFF and next >= 0xDC00 and next <= 0xDFFF)
+					{
+						codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (next - 0xDC00);
+						++i;
+					}
+					else
+					{
+						codePoint = 0xFFFD;
+					}
+				}
+				else if (codePoint > 0x10FFFF)
+				{
+					codePoint = 0xFFFD;
+				}
+
+				if (codePoint < 0x800)
+				{
+					*target++ = static_cast<unsigned char>(0xC0 | (codePoint >> 6));
+				}
+				else if (codePoint < 0x10000)
+				{
+					*target++ = static_cast<unsigned char>(0xE0 | (codePoint >> 12));
+					*target++ = static_cast<unsigned char>(0x80 | ((codePoint >> 6) & 0x3F));
+				}
+				else
+				{
+					*target++ = static_cast<unsigned char>(0xF0 | (codePoint >> 18));
+					*target++ = static_cast<unsigned char>(0x80 | ((codePoint >> 12) & 0x3F));
+					*target++ = static_cast<unsigned char>(0x80 | ((codePoint >> 6) & 0x3F));
+				}
+
+				*target++ = static_cast<unsigned char>(0x80 | (codePoint & 0x3F));
+			}
+
+			output.resize(static_cast<std::size_t>(reinterpret_cast<char*>(target) - output.data()));
+		}
+	}
+
+	/// Appends UTF-8 encoded bytes to the line. They are copied as is for a UTF-8 build;
+	/// wide builds decode them, and malformed or truncated sequences become U+FFFD.
+	inline void AppendFromUtf8(Line& output, const std::string_view text)
+	{
+		if constexpr (sizeof(Char) == 1)
+		{
+			output.append(text.begin(), text.end());
+		}
+		else
+		{
+			for (std::size_t i = 0; i < text.length();)
+			{
+				const auto lead = static_cast<unsigned char>(text[i++]);
+				if (lead < 0x80)
+				{
+					output += static_cast<Char>(lead);
+					continue;
+				}
+
+				const std::size_t length = lead >= 0xF0 ? 3 : lead >= 0xE0 ? 2 : lead >= 0xC0 ? 1 : 0;
+				char32_t codePoint = lead & (0x3F >> length);
+				std::size_t continued = 0;
+
+				while (continued < length and i < text.length() and (static_cast<unsigned char>(text[i]) & 0xC0) == 0x80)
+				{
+					codePoint = codePoint << 6 | (static_cast<unsigned char>(text[i++]) & 0x3F);
+					++continued;
+				}
+
+				const bool valid = length > 0 and continued == length and codePoint <= 0x10FFFF and (codePoint < 0xD800 or codePoint > 0xDFFF);
+				AppendCodePoint(output, valid ? codePoint : char32_t(0xFFFD));
+			}
+		}
+	}
+
+	/// Appends narrow text such as std::exception::what() or source file names to the line.
+	/// Compilers and the standard library hand these out as UTF-8, so wide builds decode them like AppendFromUtf8.
+	inline void AppendNarrow(Line& output, const std::string_view text)
+	{
+		AppendFromUtf8(output, text);
+	}
+
+	/// Returns the number of code points in the line, which is the number of columns it
+	/// takes up on a terminal for most text. For UTF-8 this skips continuation bytes.
+	[[nodiscard]] constexpr std::size_t GetDisplayWidth(const LineView line) noexcept
+	{
+		if constexpr (sizeof(Char) == 1)
+		{
+			std::size_t width = 0;
+			for (const auto character : line)
+			{
+				if ((static_cast<unsigned char>(character) & 0xC0) != 0x80) ++width;
+			}
+
+			return width;
+		}
+		else
+		{
+			return line.length();
+		}
+	}
+
+}
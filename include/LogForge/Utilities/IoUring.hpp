@@ -0,0 +1,188 @@
+#pragma once
+
+/// LOGFORGE_HAS_IO_URING is 1 if the kernel headers for io_uring are available.
+/// Whether the running kernel supports it is only known once an IoUring is created.
+#if defined(__linux__) and __has_include(<linux/io_uring.h>)
+#define LOGFORGE_HAS_IO_URING 1
+#else
+#define LOGFORGE_HAS_IO_URING 0
+#endif
+
+#if LOGFORGE_HAS_IO_URING
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+namespace LogForge
+{
+
+	/// Minimal io_uring instance that talks to the kernel through the raw system calls.
+	///
+	/// Only what the outputs need is wrapped: queueing submissions, entering the
+	/// kernel, reaping completions and registering buffers. A single thread must
+	/// own the ring; it is not safe to share.
+	class IoUring final
+	{
+	public:
+
+		/// Creates a ring with room for the given number of submissions. Check IsValid() for the result.
+		explicit IoUring(const unsigned entries) noexcept
+		{
+			io_uring_params params = {};
+			m_Descriptor = static_cast<int>(::syscall(__NR_io_uring_setup, entries, &params));
+			if (m_Descriptor < 0) return;
+
+			m_SubmissionRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+			m_CompletionRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+			const bool singleMapping = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+			if (singleMapping)
+			{
+				m_SubmissionRingSize = m_CompletionRingSize = std::max(m_SubmissionRingSize, m_CompletionRingSize);
+			}
+
+			m_SubmissionRing = Map(m_SubmissionRingSize, IORING_OFF_SQ_RING);
+			m_CompletionRing = singleMapping ? m_SubmissionRing : Map(m_CompletionRingSize, IORING_OFF_CQ_RING);
+			m_SubmissionEntriesSize = params.sq_entries * sizeof(io_uring_sqe);
+			m_SubmissionEntries = static_cast<io_uring_sqe*>(Map(m_SubmissionEntriesSize, IORING_OFF_SQES));
+
+			if (m_SubmissionRing == nullptr or m_CompletionRing == nullptr or m_SubmissionEntries == nullptr)
+			{
+				Release();
+				return;
+			}
+
+			auto* submissionRing = static_cast<char*>(m_SubmissionRing);
+			m_SubmissionHead = reinterpret_cast<unsigned*>(submissionRing + params.sq_off.head);
+			m_SubmissionTail = reinterpret_cast<unsigned*>(submissionRing + params.sq_off.tail);
+			m_SubmissionMask = *reinterpret_cast<unsigned*>(submissionRing + params.sq_off.ring_mask);
+			m_SubmissionArray = reinterpret_cast<unsigned*>(submissionRing + params.sq_off.array);
+			m_QueuedTail = *m_SubmissionTail;
+
+			auto* completionRing = static_cast<char*>(m_CompletionRing);
+			m_CompletionHead = reinterpret_cast<unsigned*>(completionRing + params.cq_off.head);
+			m_CompletionTail = reinterpret_cast<unsigned*>(completionRing + params.cq_off.tail);
+			m_CompletionMask = *reinterpret_cast<unsigned*>(completionRing + params.cq_off.ring_mask);
+			m_Completions = reinterpret_cast<io_uring_cqe*>(completionRing + params.cq_off.cqes);
+		}
+
+		IoUring(const IoUring&) = delete;
+		IoUring& operator = (const IoUring&) = delete;
+
+		~IoUring()
+		{
+			Release();
+		}
+
+		[[nodiscard]] bool IsValid() const noexcept
+		{
+			return m_Descriptor >= 0;
+		}
+
+		/// Registers buffers that fixed reads and writes can refer to by index
+		[[nodiscard]] bool RegisterBuffers(const iovec* buffers, const unsigned count) noexcept
+		{
+			return ::syscall(__NR_io_uring_register, m_Descriptor, IORING_REGISTER_BUFFERS, buffers, count) == 0;
+		}
+
+		/// Returns a cleared submission entry that is queued by the next Submit(), or nullptr if the queue is full
+		[[nodiscard]] io_uring_sqe* GetSubmission() noexcept
+		{
+			const auto head = std::atomic_ref(*m_SubmissionHead).load(std::memory_order_acquire);
+			if (m_QueuedTail - head > m_SubmissionMask) return nullptr;
+
+			const auto index = m_QueuedTail++ & m_SubmissionMask;
+			auto* entry = &m_SubmissionEntries[index];
+			std::memset(entry, 0, sizeof(io_uring_sqe));
+			m_SubmissionArray[index] = index;
+			return entry;
+		}
+
+		/// Hands queued submissions to the kernel and waits until at least the given number of completions are available.
+		/// Returns false on errors other than an interruption.
+		bool Submit(const unsigned waitFor = 0) noexcept
+		{
+			std::atomic_ref(*m_SubmissionTail).store(m_QueuedTail, std::memory_order_release);
+
+			const auto pending = m_QueuedTail - std::atomic_ref(*m_SubmissionHead).load(std::memory_order_acquire);
+			if (pending == 0 and waitFor == 0) return true;
+
+			for (;;)
+			{
+				const auto result = ::syscall(__NR_io_uring_enter, m_Descriptor, pending, waitFor, waitFor > 0 ? IORING_ENTER_GETEVENTS : 0u, nullptr, 0);
+				if (result >= 0) return true;
+				if (errno != EINTR) return false;
+			}
+		}
+
+		/// Calls the handler for every available completion and returns their number.
+		/// The handler may submit again, and may reap again itself.
+		template <typename Handler>
+		unsigned Reap(Handler&& handler)
+		{
+			unsigned reaped = 0;
+			for (;;)
+			{
+				const auto head = std::atomic_ref(*m_CompletionHead).load(std::memory_order_relaxed);
+				if (head == std::atomic_ref(*m_CompletionTail).load(std::memory_order_acquire)) return reaped;
+
+				const auto completion = m_Completions[head & m_CompletionMask];
+				std::atomic_ref(*m_CompletionHead).store(head + 1, std::memory_order_release);
+				handler(completion);
+				++reaped;
+			}
+		}
+
+	private:
+
+		[[nodiscard]] void* Map(const std::size_t size, const unsigned long long offset) const noexcept
+		{
+			void* memory = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_Descriptor, static_cast<off_t>(offset));
+			return memory == MAP_FAILED ? nullptr : memory;
+		}
+
+		void Release() noexcept
+		{
+			if (m_SubmissionEntries != nullptr) ::munmap(m_SubmissionEntries, m_SubmissionEntriesSize);
+			if (m_CompletionRing != nullptr and m_CompletionRing != m_SubmissionRing) ::munmap(m_CompletionRing, m_CompletionRingSize);
+			if (m_SubmissionRing != nullptr) ::munmap(m_SubmissionRing, m_SubmissionRingSize);
+			if (m_Descriptor >= 0) ::close(m_Descriptor);
+
+			m_SubmissionEntries = nullptr;
+			m_CompletionRing = m_SubmissionRing = nullptr;
+			m_Descriptor = -1;
+		}
+
+		int m_Descriptor = -1;
+
+		void* m_SubmissionRing = nullptr;
+		void* m_CompletionRing = nullptr;
+		io_uring_sqe* m_SubmissionEntries = nullptr;
+		std::size_t m_SubmissionRingSize = 0;
+		std::size_t m_CompletionRingSize = 0;
+		std::size_t m_SubmissionEntriesSize = 0;
+
+		unsigned* m_SubmissionHead = nullptr;
+		unsigned* m_SubmissionTail = nullptr;
+		unsigned* m_SubmissionArray = nullptr;
+		unsigned m_SubmissionMask = 0;
+		unsigned m_QueuedTail = 0;
+
+		unsigned* m_CompletionHead = nullptr;
+		unsigned* m_CompletionTail = nullptr;
+		io_uring_cqe* m_Completions = nullptr;
+		unsigned m_CompletionMask = 0;
+
+	};
+
+}
+
+#endif
@@ -0,0 +1,150 @@
+#pragma once
+
+#include <atomic>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+namespace LogForge
+{
+
+	/// Bounded lock-free queue for many producers and a single consumer.
+	///
+	/// Every slot carries a sequence number that tells producers and the consumer
+	/// whether it is free or filled, so neither side ever takes a lock.
+	/// Slots are default-constructed once and assigned on push, which lets
+	/// element types such as strings reuse their capacity across laps.
+	template <typename T>
+	class RingBuffer final
+	{
+	public:
+
+		/// Capacity used when none is given. Always a power of two.
+		static constexpr std::size_t DefaultCapacity = 8192;
+
+		/// Constructor that rounds the capacity up to the next power of two
+		explicit RingBuffer(const std::size_t capacity = DefaultCapacity) :
+			m_Mask(std::bit_ceil(capacity < 2 ? std::size_t(2) : capacity) - 1),
+			m_Slots(std::make_unique<Slot[]>(m_Mask + 1))
+		{
+			for (std::size_t i = 0; i <= m_Mask; ++i)
+			{
+				m_Slots[i].Sequence.store(i, std::memory_order_relaxed);
+			}
+		}
+
+		RingBuffer(const RingBuffer&) = delete;
+		RingBuffer& operator = (const RingBuffer&) = delete;
+
+		/// Copies or moves the value into the next free slot. Returns false if the queue is full.
+		template <typename U>
+		[[nodiscard]] bool TryPush(U&& value)
+		{
+			return TryPushWith([&value](T& slot) { slot = std::forward<U>(value); });
+		}
+
+		/// Lets the producer fill the next free slot in place. Returns false if the queue is full.
+		///
+		/// The slot still holds the element of the previous lap, so the producer can
+		/// reuse its memory. It is published to the consumer after the producer returns.
+		template <std::invocable<T&> Producer>
+		[[nodiscard]] bool TryPushWith(Producer&& producer)
+		{
+			std::size_t position = m_Head.load(std::memory_order_relaxed);
+			Slot* slot;
+
+			for (;;)
+			{
+				slot = &m_Slots[position & m_Mask];
+				const auto sequence = slot->Sequence.load(std::memory_order_acquire);
+				const auto difference = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(position);
+
+				if (difference == 0)
+				{
+					if (m_Head.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) break;
+				}
+				else if (difference < 0)
+				{
+					return false;
+				}
+				else
+				{
+					position = m_Head.load(std::memory_order_relaxed);
+				}
+			}
+
+			std::forward<Producer>(producer)(slot->Value);
+			slot->Sequence.store(position + 1, std::memory_order_release);
+			return true;
+		}
+
+		/// Hands the oldest element to the consumer in place. Returns false if the queue is empty.
+		///
+		/// The slot is released only after the consumer returns, so the element
+		/// never has to be moved out of the queue. If the consumer throws, the
+		/// element counts as popped and the slot is released all the same.
+		template <std::invocable<T&> Consumer>
+		[[nodiscard]] bool TryPop(Consumer&& consumer)
+		{
+			const std::size_t position = m_Tail.load(std::memory_order_relaxed);
+			Slot& slot = m_Slots[position & m_Mask];
+
+			const auto sequence = slot.Sequence.load(std::memory_order_acquire);
+			if (sequence != position + 1) return false;
+
+			m_Tail.store(position + 1, std::memory_order_relaxed);
+
+			// Producers wait for this sequence once the ring wraps, so it has to be stored even when unwinding
+			struct Release
+			{
+				~Release() { Target.Sequence.store(Sequence, std::memory_order_release); }
+
+				Slot& Target;
+				std::size_t Sequence;
+			} release { slot, position + m_Mask + 1 };
+
+			std::forward<Consumer>(consumer)(slot.Value);
+			return true;
+		}
+
+		/// Returns true if the consumer would currently find nothing to pop
+		[[nodiscard]] bool IsEmpty() const noexcept
+		{
+			const std::size_t position = m_Tail.load(std::memory_order_relaxed);
+			return m_Slots[position & m_Mask].Sequence.load(std::memory_order_acquire) != position + 1;
+		}
+
+		/// Returns the number of slots that producers have claimed so far, including slots that are still being filled.
+		/// Elements are popped in the order of their slots, so once the consumer has popped this many elements,
+		/// everything pushed before the call has been consumed.
+		[[nodiscard]] std::size_t GetClaimed() const noexcept
+		{
+			return m_Head.load(std::memory_order_acquire);
+		}
+
+		[[nodiscard]] std::size_t Capacity() const noexcept
+		{
+			return m_Mask + 1;
+		}
+
+	private:
+
+		static constexpr std::size_t CacheLineSize = 64;
+
+		struct Slot
+		{
+			std::atomic<std::size_t> Sequence;
+			T Value;
+		};
+
+		std::size_t m_Mask;
+		std::unique_ptr<Slot[]> m_Slots;
+		alignas(CacheLineSize) std::atomic<std::size_t> m_Head = 0;
+		alignas(CacheLineSize) std::atomic<std::size_t> m_Tail = 0;
+
+	};
+
+}
@@ -0,0 +1,73 @@
+// Turns a log written by LogForge::BinaryOutput back into text.
+//
+// Usage: DecodeBinaryLog [--message | --prefixed | --timestamped | --located | --logfmt] <file>
+//
+// Build it next to the program that wrote the log, e.g.
+//   c++ -std=c++20 -DLOGFORGE_UTF8 -Iinclude tools/DecodeBinaryLog.cpp -o DecodeBinaryLog
+
+#include <LogForge/LogForge.hpp>
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+namespace
+{
+
+	LogForge::OutputStream& GetStandardOutput()
+	{
+	#ifdef LOGFORGE_UTF8
+		return std::cout;
+	#else
+		return std::wcout;
+	#endif
+	}
+
+	int Decode(std::istream& input, const std::derived_from<LogForge::LogPrinter> auto printer)
+	{
+		using namespace LogForge;
+
+		const auto logger = DefaultLogger(ProductionFilter(), StreamOutput(GetStandardOutput(), FlushPolicy::Never()), printer);
+
+		BinaryDecoder decoder(input);
+		decoder.Replay(logger);
+		GetStandardOutput().flush();
+
+		if (const auto* error = decoder.GetError(); error != nullptr)
+		{
+			std::cerr << "DecodeBinaryLog: " << error << '\n';
+			return 1;
+		}
+
+		return 0;
+	}
+
+}
+
+int main(const int argc, const char* argv[])
+{
+	using namespace LogForge;
+
+	if (argc < 2 or argc > 3)
+	{
+		std::cerr << "Usage: DecodeBinaryLog [--message | --prefixed | --timestamped | --located | --logfmt] <file>\n";
+		return 2;
+	}
+
+	const char* format = argc == 3 ? argv[1] : "--prefixed";
+	std::ifstream input(argv[argc - 1], std::ios::binary);
+	if (not input)
+	{
+		std::cerr << "DecodeBinaryLog: cannot open " << argv[argc - 1] << '\n';
+		return 1;
+	}
+
+	if (std::strcmp(format, "--message") == 0) return Decode(input, Message());
+	if (std::strcmp(format, "--prefixed") == 0) return Decode(input, Message() >> Prefixed());
+	if (std::strcmp(format, "--timestamped") == 0) return Decode(input, Message() >> Prefixed() >> Timestamped());
+	if (std::strcmp(format, "--located") == 0) return Decode(input, Message() >> Prefixed() >> Located());
+	if (std::strcmp(format, "--logfmt") == 0) return Decode(input, LogFmt());
+
+	std::cerr << "DecodeBinaryLog: unknown format " << format << '\n';
+	return 2;
+}
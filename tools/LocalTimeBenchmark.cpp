@@ -0,0 +1,103 @@
+// Compares LogForge::ToLocalTime with the C library's localtime_r.
+//
+// Usage: LocalTimeBenchmark [threads...]
+//
+// Every thread converts the same number of timestamps. The default thread counts are 1, 8 and 64.
+// Build it with optimizations, e.g.
+//   c++ -std=c++20 -O2 -pthread -Iinclude tools/LocalTimeBenchmark.cpp -o LocalTimeBenchmark
+
+#include <LogForge/Time/LocalTime.hpp>
+
+#include <chrono>
+#include <cstdlib>
+#include <ctime>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+	constexpr int ConversionsPerThread = 200'000;
+
+	/// Runs convert on every thread and returns the total conversions per second.
+	double Measure(const int threadCount, int (*convert)(std::time_t))
+	{
+		std::vector<std::thread> threads;
+		threads.reserve(static_cast<std::size_t>(threadCount));
+
+		const auto start = std::chrono::steady_clock::now();
+
+		for (int i = 0; i < threadCount; ++i)
+		{
+			threads.emplace_back([convert, i]
+			{
+				// Spread the timestamps over a few years so both DST states are hit.
+				std::time_t time = 1'600'000'000 + i * 7919;
+				volatile int sink = 0;
+				for (int n = 0; n < ConversionsPerThread; ++n)
+				{
+					sink = sink + convert(time);
+					time += 613;
+				}
+			});
+		}
+
+		for (auto& thread : threads)
+			thread.join();
+
+		const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+		return static_cast<double>(threadCount) * ConversionsPerThread / elapsed.count();
+	}
+
+	int ConvertWithLogForge(const std::time_t time)
+	{
+		const auto result = LogForge::ToLocalTime(time);
+		return result.has_value() ? result->tm_hour : -1;
+	}
+
+	int ConvertWithLibrary(const std::time_t time)
+	{
+		std::tm result = {};
+	#if defined(_WIN32)
+		if (localtime_s(&result, &time) != 0) return -1;
+	#else
+		if (localtime_r(&time, &result) == nullptr) return -1;
+	#endif
+		return result.tm_hour;
+	}
+
+}
+
+int main(const int argc, char* argv[])
+{
+	std::vector<int> threadCounts;
+	for (int i = 1; i < argc; ++i)
+	{
+		const int count = std::atoi(argv[i]);
+		if (count <= 0)
+		{
+			std::cerr << "Usage: LocalTimeBenchmark [threads...]\n";
+			return 2;
+		}
+		threadCounts.push_back(count);
+	}
+
+	if (threadCounts.empty())
+		threadCounts = {1, 8, 64};
+
+	// Load the zone before timing so the first measurement does not include it.
+	ConvertWithLogForge(0);
+	ConvertWithLibrary(0);
+
+	std::cout << "threads  ToLocalTime  localtime_r  (million conversions per second)\n" << std::fixed << std::setprecision(2);
+	for (const int threadCount : threadCounts)
+	{
+		const double logForge = Measure(threadCount, ConvertWithLogForge) / 1e6;
+		const double library = Measure(threadCount, ConvertWithLibrary) / 1e6;
+		std::cout << std::setw(7) << threadCount << std::setw(13) << logForge << std::setw(13) << library << '\n';
+	}
+
+	return 0;
+}